@@ -0,0 +1,86 @@
+#include "alloc_hook.h"
+
+#include <cstdlib>
+#include <new>
+
+// one counter per thread: no atomic operation on the allocation path
+static thread_local uint64_t allocations = 0;
+
+uint64_t thread_allocations()
+{
+	return allocations;
+}
+
+static void * allocate(std::size_t size)
+{
+	++allocations;
+	void * p = std::malloc(size ? size : 1);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+static void * allocate(std::size_t size, std::align_val_t align)
+{
+	++allocations;
+	std::size_t a = static_cast<std::size_t>(align);
+	if (a < sizeof(void *))
+		a = sizeof(void *);
+	void * p = nullptr;
+	if (posix_memalign(&p, a, size ? size : 1) != 0)
+		throw std::bad_alloc();
+	return p;
+}
+
+void * operator new(std::size_t size)
+{
+	return allocate(size);
+}
+
+void * operator new[](std::size_t size)
+{
+	return allocate(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void * operator new(std::size_t size, std::align_val_t align)
+{
+	return allocate(size, align);
+}
+
+void * operator new[](std::size_t size, std::align_val_t align)
+{
+	return allocate(size, align);
+}
+
+void * operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+	try { return allocate(size, align); } catch (...) { return nullptr; }
+}
+
+void * operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+	try { return allocate(size, align); } catch (...) { return nullptr; }
+}
+
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete[](void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::size_t) noexcept { std::free(p); }
+void operator delete(void * p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void * p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void * p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void * p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void * p, std::align_val_t, const std::nothrow_t &) noexcept { std::free(p); }
@@ -0,0 +1,13 @@
+#ifndef ALLOC_HOOK_H
+#define ALLOC_HOOK_H
+
+#include <cstdint>
+
+// Counting hook on the global allocation functions: alloc_hook.cpp replaces every form of
+// operator new/new[] (plain, nothrow, aligned) with malloc-based versions that count the
+// calls made by each thread. Used to verify that real-time threads do not allocate.
+
+// allocations made so far by the calling thread
+uint64_t thread_allocations();
+
+#endif
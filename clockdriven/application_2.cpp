@@ -2,6 +2,7 @@
 #include <iostream>
 
 #include "busy_wait.h"
+#include "trace.h"
 
 void task0()
 {
@@ -48,6 +49,9 @@ int main()
 {
 	busy_wait_init();
 
+	// eventi dell'executive in forma leggibile, scritti da un thread a bassa priorità
+	Tracer::global().start_drain_thread(std::cout, Tracer::Format::Text);
+
 	Executive exec(6, 5);
 
 	exec.set_periodic_task(0, task0, 2);
@@ -2,6 +2,7 @@
 #include <iostream>
 
 #include "busy_wait.h"
+#include "trace.h"
 
 void task0()
 {
@@ -60,13 +61,16 @@ int main()
 {
 	busy_wait_init();
 
+	// eventi dell'executive in forma leggibile, scritti da un thread a bassa priorità
+	Tracer::global().start_drain_thread(std::cout, Tracer::Format::Text);
+
 	Executive exec(6, 5);
 
 	exec.set_periodic_task(0, task0, 2);
 	exec.set_periodic_task(1, task1, 1);
 	exec.set_periodic_task(2, task2, 2);
 	exec.set_periodic_task(3, task3, 2);
-	exec.set_periodic_task(4, std::bind(task4, std::ref(exec)), 3);
+	exec.set_periodic_task(4, [&exec]() { task4(exec); }, 3);
 	exec.set_periodic_task(5, task5, 1);
 	
 	exec.set_aperiodic_task(task_ap, 5);
@@ -0,0 +1,58 @@
+#include "partitioned_executive.h"
+#include <iostream>
+#include <thread>
+
+#include "busy_wait.h"
+
+void task0()
+{
+	std::cout << "[Core 0] Sono il task n.0" << std::endl;
+	busy_wait(90);
+}
+
+void task1()
+{
+	std::cout << "[Core 0] Sono il task n.1" << std::endl;
+	busy_wait(185);
+}
+
+void task2()
+{
+	std::cout << "[Core 1] Sono il task n.2" << std::endl;
+	busy_wait(15);
+}
+
+void task3()
+{
+	std::cout << "[Core 1] Sono il task n.3" << std::endl;
+	busy_wait(17);
+}
+
+int main()
+{
+	busy_wait_init();
+
+	PartitionedExecutive pexec;
+
+	Executive & core0 = pexec.add_core(0, 2, 4, 100);
+	core0.set_periodic_task(0, task0, 1);
+	core0.set_periodic_task(1, task1, 2);
+	core0.add_frame({0,1});
+	core0.add_frame({0});
+
+	Executive & core1 = pexec.add_core(1, 2, 5);
+	core1.set_periodic_task(0, task2, 2);
+	core1.set_periodic_task(1, task3, 2);
+	core1.add_frame({0,1});
+	core1.add_frame({1});
+
+	pexec.start();
+
+	while (true)
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		pexec.report(std::cout);
+	}
+
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include "executive.h"
+#include <iostream>
+#include <thread>
+
+#include "busy_wait.h"
+
+// anello di controllo a 20 kHz: quanti di 25us, frame di 2 quanti (50us)
+
+void control()
+{
+	busy_wait_us(8);
+}
+
+void sensor()
+{
+	busy_wait_us(5);
+}
+
+void logger()
+{
+	busy_wait_us(5);
+}
+
+int main()
+{
+	busy_wait_init();
+
+	Executive exec(3, 2, std::chrono::microseconds(25));
+
+	exec.set_periodic_task(0, control, 1);
+	exec.set_periodic_task(1, sensor, 1);
+	exec.set_periodic_task(2, logger, 1);
+
+	exec.add_frame({0,1});
+	exec.add_frame({0,2});
+
+	// risveglio con clock_nanosleep assoluto e busy-wait negli ultimi 10us
+	exec.set_frame_timer(rt::timer_backend::nanosleep, std::chrono::microseconds(10));
+
+	exec.start();
+
+	while (true)
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+
+		Executive::Stats st = exec.stats();
+		std::cout << "frame: " << st.frames
+			<< ", ritardo del risveglio p99: " << st.wakeup_lateness.p99.count() << " ns"
+			<< ", jitter del controllo p99: " << st.tasks[0].release_jitter.p99.count() << " ns"
+			<< ", deadline miss: " << st.tasks[0].deadline_misses
+			<< ", frame saltati: " << st.timer_overruns << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include "executive.h"
+#include <iostream>
+
+#include "busy_wait.h"
+#include "schedule.h"
+#include "trace.h"
+
+// stesso schedule di application_1, definito e validato a tempo di compilazione:
+// un id fuori range o un frame con slack negativo non compilano
+typedef StaticSchedule<4,
+                       Wcets<1, 2, 1, 3, 1>,   // tau_1, tau_2, tau_3,1, tau_3,2, tau_3,3
+                       Frame<0, 1, 2>,
+                       Frame<0, 3>,
+                       Frame<0, 1>,
+                       Frame<0, 1>,
+                       Frame<0, 1, 4>> Schedule;
+
+void task0()
+{
+	std::cout << "Sono il task n.0" << std::endl;
+	busy_wait(90);
+}
+
+void task1()
+{
+	std::cout << "Sono il task n.1" << std::endl;
+	busy_wait(185);
+}
+void task2()
+{
+	std::cout << "Sono il task n.2" << std::endl;
+	busy_wait(88);
+}
+
+void task3()
+{
+	std::cout << "Sono il task n.3" << std::endl;
+	busy_wait(270);
+}
+
+void task4()
+{
+	std::cout << "Sono il task n.4" << std::endl;
+	busy_wait(80);
+}
+
+int main()
+{
+	busy_wait_init();
+
+	// eventi dell'executive in forma leggibile, scritti da un thread a bassa priorità
+	Tracer::global().start_drain_thread(std::cout, Tracer::Format::Text);
+
+	Executive exec(Schedule::num_tasks, 4, 100);
+
+	exec.set_schedule(Schedule::table());
+
+	exec.set_periodic_task(0, task0);
+	exec.set_periodic_task(1, task1);
+	exec.set_periodic_task(2, task2);
+	exec.set_periodic_task(3, task3);
+	exec.set_periodic_task(4, task4);
+	
+	exec.start();
+	exec.wait();
+	
+	return 0;
+}
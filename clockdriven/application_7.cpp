@@ -0,0 +1,65 @@
+#include "task_set.h"
+#include <iostream>
+
+#include "busy_wait.h"
+
+// lo stesso task set (quanti di 10ms) eseguito con lo schedule ciclico sintetizzato,
+// con Rate Monotonic e con EDF, per confrontarne jitter, tempi di risposta e overhead
+
+void task0()
+{
+	busy_wait(8);
+}
+
+void task1()
+{
+	busy_wait(18);
+}
+
+void task2()
+{
+	busy_wait(25);
+}
+
+static const char * policy_name(Executive::SchedPolicy policy)
+{
+	switch (policy)
+	{
+		case Executive::SchedPolicy::Cyclic: return "ciclico";
+		case Executive::SchedPolicy::RateMonotonic: return "RM";
+		case Executive::SchedPolicy::Edf: return "EDF";
+	}
+	return "?";
+}
+
+int main()
+{
+	busy_wait_init();
+
+	TaskSet set;
+	set.add_task(task0, {4, 1});
+	set.add_task(task1, {8, 2});
+	set.add_task(task2, {8, 3, 6});
+
+	std::cout << "utilizzazione: " << set.utilization() << std::endl;
+
+	for (Executive::SchedPolicy policy : {Executive::SchedPolicy::Cyclic, Executive::SchedPolicy::RateMonotonic, Executive::SchedPolicy::Edf})
+	{
+		std::unique_ptr<Executive> exec = set.make_executive(policy, std::chrono::milliseconds(10));
+		exec->set_hyperperiod_limit(10);
+
+		exec->start();
+		exec->wait();
+
+		Executive::Stats st = exec->stats();
+		std::cout << policy_name(policy) << ": frame " << st.frames
+			<< ", CPU dell'executive per frame p99: " << st.exec_cpu_per_frame.p99.count() << " ns" << std::endl;
+		for (size_t id = 0; id < set.size(); ++id)
+			std::cout << "  task " << id
+				<< ": jitter p99 " << st.tasks[id].release_jitter.p99.count() << " ns"
+				<< ", risposta max " << st.tasks[id].response_time.max.count() << " ns"
+				<< ", deadline miss " << st.tasks[id].deadline_misses << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+// Task callable microbenchmark.
+// Compares the per-job call cost and the setup allocations of std::function (the task
+// storage of the first version of the executive) with InlineFunction, now used for
+// Executive::Task and Executive::ApTask, and with a plain function pointer as reference.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+
+#include "inline_function.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+// heap allocations performed while building the callables
+static std::atomic<size_t> allocations{0};
+
+void * operator new(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void * p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void * p, size_t) noexcept
+{
+	std::free(p);
+}
+
+static volatile unsigned long sink = 0;
+
+static void job()
+{
+	sink = sink + 1;
+}
+
+static void job_ctx(void * ctx)
+{
+	*static_cast<volatile unsigned long *>(ctx) = *static_cast<volatile unsigned long *>(ctx) + 1;
+}
+
+// the call site is kept out of line so that the compiler cannot see through the callable
+template <typename F>
+__attribute__((noinline)) static void call(const F & f)
+{
+	f();
+}
+
+template <typename F>
+static double ns_per_call(const F & f, unsigned int iterations)
+{
+	double best = 1e30;
+	for (int run = 0; run < 5; ++run)
+	{
+		auto start = clock_type::now();
+		for (unsigned int i = 0; i < iterations; ++i)
+			call(f);
+		double ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / iterations;
+		if (ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+template <typename F, typename Make>
+static void report(const char * name, Make make, unsigned int iterations)
+{
+	size_t before = allocations.load();
+	F f = make();
+	size_t allocs = allocations.load() - before;
+
+	std::cout << name
+		<< "\t" << ns_per_call(f, iterations) << " ns/call"
+		<< "\t" << allocs << " allocations"
+		<< "\t" << sizeof(F) << " bytes" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+	unsigned int iterations = (argc > 1) ? std::atoi(argv[1]) : 10000000;
+	if (iterations == 0)
+		iterations = 1;
+
+	// a capture of the size of a typical task context (object pointer + two parameters)
+	struct Context { volatile unsigned long * counter; long a, b; };
+	Context c{&sink, 1, 2};
+	auto lambda = [c]() { *c.counter = *c.counter + c.a + c.b; };
+
+	std::cout << "task call cost, " << iterations << " calls (best of 5)" << std::endl;
+
+	typedef void (*fn_ptr)();
+	report<fn_ptr>("function pointer         ", []() { return &job; }, iterations);
+
+	report<std::function<void()>>("std::function (pointer)  ", []() { return std::function<void()>(job); }, iterations);
+	report<InlineFunction<void()>>("InlineFunction (pointer) ", []() { return InlineFunction<void()>(job); }, iterations);
+
+	report<std::function<void()>>("std::function (lambda)   ", [&]() { return std::function<void()>(lambda); }, iterations);
+	report<InlineFunction<void()>>("InlineFunction (lambda)  ", [&]() { return InlineFunction<void()>(lambda); }, iterations);
+
+	report<std::function<void()>>("std::function (bind)     ", []() { return std::function<void()>(std::bind(job_ctx, (void *)&sink)); }, iterations);
+	report<InlineFunction<void()>>("InlineFunction (fn+ctx)  ", []() { return InlineFunction<void()>(job_ctx, (void *)&sink); }, iterations);
+
+	return 0;
+}
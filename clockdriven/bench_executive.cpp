@@ -0,0 +1,267 @@
+// Executive overhead benchmark on synthetic, scalable task sets.
+// Builds a schedule of --frames frames with --jobs-per-frame jobs each, drawn round-robin
+// from --tasks periodic tasks, runs it for --hyperperiods hyperperiods and prints one JSON
+// line with the configuration and the executive's own cost: CPU time of the executive
+// thread per frame, release-to-start latency of the jobs and syscalls per frame.
+//
+//   ./bench_executive --tasks 100 --frames 20 --jobs-per-frame 10 --hyperperiods 5 >> results.jsonl
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "executive.h"
+#include "trace.h"
+#include "busy_wait.h"
+
+struct Config
+{
+	unsigned int tasks = 10;
+	unsigned int frames = 10;
+	unsigned int jobs_per_frame = 4;
+	unsigned int frame_length = 1;
+	unsigned int unit_us = 1000;
+	unsigned int work_us = 0;
+	unsigned int wcet_us = 0;  // declared WCET of every task (rounded up to quanta; 0 = none)
+	unsigned int hyperperiods = 10;
+	bool trace = true;
+	bool inline_jobs = false;
+	int pool = -1;             // workers of the pool mode (0 = one per core), -1 = one thread per task
+	rt::timer_backend timer = rt::timer_backend::nanosleep;
+	unsigned int spin_us = 0;
+	bool arm = false;          // arm phase with the allocation/page-fault check
+	rt::memory_lock lock = rt::memory_lock::none;
+	bool deadline = false;     // SCHED_DEADLINE backend
+	std::string out;
+};
+
+static void usage(const char * name)
+{
+	std::cerr << "usage: " << name
+		<< " [--tasks N (1..1000)] [--frames F (1..10000)] [--jobs-per-frame J]"
+		<< " [--frame-length L] [--unit-us U] [--work-us W] [--wcet-us C] [--hyperperiods H]"
+		<< " [--timer sleep|nanosleep|timerfd] [--spin-us S] [--inline | --pool W] [--arm none|all|touched] [--sched fifo|deadline] [--no-trace] [--out FILE]" << std::endl;
+}
+
+static bool parse(int argc, char * argv[], Config & c)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string a = argv[i];
+		if (a == "--no-trace")
+		{
+			c.trace = false;
+			continue;
+		}
+		if (a == "--inline")
+		{
+			c.inline_jobs = true;
+			continue;
+		}
+		if (i + 1 >= argc)
+			return false;
+
+		const char * v = argv[++i];
+		if (a == "--tasks")
+			c.tasks = std::atoi(v);
+		else if (a == "--frames")
+			c.frames = std::atoi(v);
+		else if (a == "--jobs-per-frame")
+			c.jobs_per_frame = std::atoi(v);
+		else if (a == "--frame-length")
+			c.frame_length = std::atoi(v);
+		else if (a == "--unit-us")
+			c.unit_us = std::atoi(v);
+		else if (a == "--work-us")
+			c.work_us = std::atoi(v);
+		else if (a == "--wcet-us")
+			c.wcet_us = std::atoi(v);
+		else if (a == "--sched")
+		{
+			std::string b = v;
+			if (b == "fifo")
+				c.deadline = false;
+			else if (b == "deadline")
+				c.deadline = true;
+			else
+				return false;
+		}
+		else if (a == "--hyperperiods")
+			c.hyperperiods = std::atoi(v);
+		else if (a == "--timer")
+		{
+			std::string t = v;
+			if (t == "sleep")
+				c.timer = rt::timer_backend::sleep;
+			else if (t == "nanosleep")
+				c.timer = rt::timer_backend::nanosleep;
+			else if (t == "timerfd")
+				c.timer = rt::timer_backend::timerfd;
+			else
+				return false;
+		}
+		else if (a == "--arm")
+		{
+			std::string m = v;
+			c.arm = true;
+			if (m == "none")
+				c.lock = rt::memory_lock::none;
+			else if (m == "all")
+				c.lock = rt::memory_lock::all;
+			else if (m == "touched")
+				c.lock = rt::memory_lock::touched;
+			else
+				return false;
+		}
+		else if (a == "--spin-us")
+			c.spin_us = std::atoi(v);
+		else if (a == "--pool")
+			c.pool = std::atoi(v);
+		else if (a == "--out")
+			c.out = v;
+		else
+			return false;
+	}
+
+	return !(c.inline_jobs && c.pool >= 0) && c.tasks >= 1 && c.tasks <= 1000 && c.frames >= 1 && c.frames <= 10000
+		&& c.jobs_per_frame >= 1 && c.frame_length >= 1 && c.unit_us >= 1 && c.hyperperiods >= 1;
+}
+
+static void json_latency(std::ostream & out, const char * key, const Executive::LatencyStats & l)
+{
+	out << "\"" << key << "\":{"
+		<< "\"count\":" << l.count
+		<< ",\"min\":" << l.min.count()
+		<< ",\"mean\":" << l.mean.count()
+		<< ",\"p50\":" << l.p50.count()
+		<< ",\"p99\":" << l.p99.count()
+		<< ",\"p999\":" << l.p999.count()
+		<< ",\"max\":" << l.max.count()
+		<< "}";
+}
+
+int main(int argc, char * argv[])
+{
+	Config c;
+	if (!parse(argc, argv, c))
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	Tracer::global().set_enabled(c.trace);
+	if (c.work_us)
+		busy_wait_init();
+
+	Executive exec(c.tasks, c.frame_length, std::chrono::microseconds(c.unit_us));
+
+	if (c.arm)
+	{
+		Executive::ArmConfig arm;
+		arm.memory_lock = c.lock;
+		arm.check = true;
+		exec.set_arm(arm);
+	}
+
+	if (c.inline_jobs)
+		exec.set_execution_mode(Executive::ExecMode::Inline);
+	else if (c.pool >= 0)
+		exec.set_execution_mode(Executive::ExecMode::Pool, c.pool);
+
+	if (c.deadline)
+		exec.set_sched_backend(Executive::SchedBackend::Deadline);
+
+	const unsigned int work_us = c.work_us;
+	const unsigned int wcet = (c.wcet_us + c.unit_us - 1) / c.unit_us;
+	for (unsigned int t = 0; t < c.tasks; ++t)
+		exec.set_periodic_task(t, [work_us]() { if (work_us) busy_wait_us(work_us); }, wcet);
+
+	unsigned int jobs = c.jobs_per_frame < c.tasks ? c.jobs_per_frame : c.tasks;
+	for (unsigned int f = 0; f < c.frames; ++f)
+	{
+		std::vector<size_t> frame;
+		for (unsigned int j = 0; j < jobs; ++j)
+			frame.push_back((static_cast<size_t>(f) * jobs + j) % c.tasks);
+		exec.add_frame(frame);
+	}
+
+	exec.set_frame_timer(c.timer, std::chrono::microseconds(c.spin_us));
+	exec.set_hyperperiod_limit(c.hyperperiods);
+	exec.start();
+	exec.wait();
+
+	Executive::Stats st = exec.stats();
+
+	// release latency aggregated over all tasks: exact count/min/mean/max, worst per-task percentiles
+	Executive::LatencyStats rl{};
+	long double weighted = 0;
+	bool first = true;
+	uint64_t misses = 0;
+	for (const auto & ts : st.tasks)
+	{
+		misses += ts.deadline_misses;
+		const auto & l = ts.release_latency;
+		if (l.count == 0)
+			continue;
+		if (first || l.min < rl.min)
+			rl.min = l.min;
+		first = false;
+		rl.count += l.count;
+		weighted += static_cast<long double>(l.mean.count()) * l.count;
+		rl.max = std::max(rl.max, l.max);
+		rl.p50 = std::max(rl.p50, l.p50);
+		rl.p90 = std::max(rl.p90, l.p90);
+		rl.p99 = std::max(rl.p99, l.p99);
+		rl.p999 = std::max(rl.p999, l.p999);
+		rl.p9999 = std::max(rl.p9999, l.p9999);
+	}
+	if (rl.count)
+		rl.mean = std::chrono::nanoseconds(static_cast<long long>(weighted / rl.count));
+
+	std::ostringstream line;
+	line << "{\"tasks\":" << c.tasks
+		<< ",\"frames\":" << c.frames
+		<< ",\"jobs_per_frame\":" << jobs
+		<< ",\"frame_length\":" << c.frame_length
+		<< ",\"unit_us\":" << c.unit_us
+		<< ",\"work_us\":" << c.work_us
+		<< ",\"hyperperiods\":" << c.hyperperiods
+		<< ",\"timer\":\"" << rt::to_string(c.timer) << "\""
+		<< ",\"spin_us\":" << c.spin_us
+		<< ",\"mode\":\"" << (c.inline_jobs ? "inline" : c.pool >= 0 ? "pool" : "threads") << "\""
+		<< ",\"pool_workers\":" << (c.pool >= 0 ? c.pool : 0)
+		<< ",\"trace\":" << (c.trace ? "true" : "false")
+		<< ",\"arm\":\"" << (c.arm ? rt::to_string(c.lock) : "off") << "\""
+		<< ",\"sched\":\"" << (st.sched_deadline ? "deadline" : "fifo") << "\""
+		<< ",\"deadline_fallbacks\":" << st.deadline_fallbacks
+		<< ",\"memory_locked\":" << (st.memory_locked ? "true" : "false")
+		<< ",\"rt_allocations\":" << st.rt_allocations
+		<< ",\"rt_page_faults\":" << st.rt_page_faults
+		<< ",\"frames_run\":" << st.frames
+		<< ",\"deadline_misses\":" << misses
+		<< ",\"timer_overruns\":" << st.timer_overruns
+		<< ",\"syscalls_per_frame\":" << st.syscalls_per_frame
+		<< ",\"max_syscalls_per_frame\":" << st.max_syscalls_per_frame
+		<< ",";
+	json_latency(line, "exec_cpu_ns", st.exec_cpu_per_frame);
+	line << ",";
+	json_latency(line, "release_latency_ns", rl);
+	line << ",";
+	json_latency(line, "wakeup_lateness_ns", st.wakeup_lateness);
+	line << "}\n";
+
+	if (c.out.empty())
+		std::cout << line.str() << std::flush;
+	else
+	{
+		std::ofstream f(c.out, std::ios::app);
+		f << line.str();
+	}
+
+	return 0;
+}
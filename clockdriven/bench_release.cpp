@@ -0,0 +1,179 @@
+// Release-to-start latency microbenchmark.
+// Compares the old job release handshake (mutex + condition_variable, as in the
+// first version of the executive) with the atomic state word + futex protocol
+// now used by Executive::release()/Executive::task_function().
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "rt/priority.h"
+#include "rt/futex.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+enum { Idle, Pending, Running, Quit };
+
+// old protocol: state under a mutex, wake-up through a condition_variable
+struct LegacyHandshake
+{
+	std::mutex state_mtx;
+	std::condition_variable cv;
+	int state = Idle;
+
+	void release(int s = Pending)
+	{
+		{
+			std::lock_guard<std::mutex> lg(state_mtx);
+			state = s;
+		}
+		cv.notify_one();
+	}
+
+	bool acquire()
+	{
+		std::unique_lock<std::mutex> lk(state_mtx);
+		while (state != Pending && state != Quit)
+			cv.wait(lk);
+		if (state == Quit)
+			return false;
+		state = Running;
+		return true;
+	}
+
+	void done()
+	{
+		std::lock_guard<std::mutex> lg(state_mtx);
+		state = Idle;
+	}
+};
+
+// new protocol: one atomic store plus one futex wake per release
+struct FutexHandshake
+{
+	std::atomic<int> state{Idle};
+
+	void release(int s = Pending)
+	{
+		state.store(s, std::memory_order_release);
+		rt::futex_wake(state);
+	}
+
+	bool acquire()
+	{
+		while (true)
+		{
+			int s = state.load(std::memory_order_acquire);
+			if (s == Quit)
+				return false;
+			if (s != Pending)
+			{
+				rt::futex_wait(state, s);
+				continue;
+			}
+			if (state.compare_exchange_strong(s, Running, std::memory_order_acq_rel))
+				return true;
+		}
+	}
+
+	void done()
+	{
+		int r = Running;
+		state.compare_exchange_strong(r, Idle, std::memory_order_acq_rel);
+	}
+};
+
+template <typename Handshake>
+static std::vector<double> measure(unsigned int iterations)
+{
+	Handshake h;
+	std::vector<double> latency(iterations);
+	std::atomic<clock_type::rep> release_stamp{0};
+	std::atomic<unsigned int> completed{0};
+
+	std::thread worker([&]() {
+		unsigned int i = 0;
+		while (h.acquire())
+		{
+			auto now = clock_type::now().time_since_epoch().count();
+			latency[i++] = (now - release_stamp.load(std::memory_order_relaxed)) / 1000.0;
+			h.done();
+			completed.store(i, std::memory_order_release);
+		}
+	});
+
+	// the worker sits above the releaser, so that the wake-up preempts it immediately
+	// and the latency is the cost of the handshake, not of the releaser's own work
+	try
+	{
+		rt::this_thread::set_priority(rt::priority::rt_max - 1);
+		rt::set_priority(worker, rt::priority::rt_max);
+	}
+	catch (rt::permission_error &)
+	{
+		std::cerr << "warning: no permission for SCHED_FIFO, measuring with normal priority" << std::endl;
+	}
+
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		release_stamp.store(clock_type::now().time_since_epoch().count(), std::memory_order_relaxed);
+		h.release();
+
+		// let the worker run, as the executive does by sleeping until the next frame
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+		while (completed.load(std::memory_order_acquire) != i + 1)
+			std::this_thread::yield();
+	}
+
+	h.release(Quit);
+	worker.join();
+
+	try
+	{
+		rt::this_thread::set_priority(rt::priority::not_rt);
+	}
+	catch (rt::permission_error &)
+	{
+	}
+
+	return latency;
+}
+
+static void report(const char * name, std::vector<double> v)
+{
+	std::sort(v.begin(), v.end());
+
+	double sum = 0;
+	for (double x : v)
+		sum += x;
+
+	auto pct = [&](double p) { return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))]; };
+
+	std::cout << name
+		<< "\tmin " << v.front()
+		<< "\tavg " << sum / v.size()
+		<< "\tp50 " << pct(0.50)
+		<< "\tp99 " << pct(0.99)
+		<< "\tmax " << v.back()
+		<< "\t(us)" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+	unsigned int iterations = (argc > 1) ? std::atoi(argv[1]) : 10000;
+	if (iterations == 0)
+		iterations = 1;
+
+	std::cout << "release-to-start latency, " << iterations << " releases" << std::endl;
+
+	report("mutex+cv", measure<LegacyHandshake>(iterations));
+	report("futex   ", measure<FutexHandshake>(iterations));
+
+	return 0;
+}
@@ -0,0 +1,206 @@
+// Task control block layout microbenchmark.
+// One releaser thread (the executive) releases N futex workers per frame, as in
+// Executive::exec_function(); each worker records its release-to-start latency.
+// Two layouts of the per-task control block are compared:
+//  - packed: handshake word, release fields and the worker's measures in one small struct,
+//    so that neighbouring tasks (and the executive's writes) share cache lines;
+//  - split:  the layout of Executive::TaskData / TaskMeasures, one 64-byte line for the
+//    handshake written by both threads and a separate line for what only the worker writes.
+// The difference is visible only on multi-core hosts, where false sharing costs coherence misses.
+//
+//   ./bench_tcb [tasks (default 64)] [frames (default 2000)]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rt/priority.h"
+#include "rt/futex.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+enum { Idle, Pending, Running, Quit };
+
+struct PackedBlock
+{
+	struct Hot
+	{
+		std::atomic<int> state{Idle};
+		unsigned int job_tag{0};
+		clock_type::rep release_stamp{0};
+		// measures, written by the worker next to the executive's fields
+		uint64_t latency_sum{0};
+		uint64_t latency_max{0};
+	};
+	typedef Hot Measures;
+
+	Hot & hot(size_t i) { return blocks[i]; }
+	Measures & measures(size_t i) { return blocks[i]; }
+
+	explicit PackedBlock(size_t n) : blocks(new Hot[n]) {}
+
+	std::unique_ptr<Hot[]> blocks;
+};
+
+struct SplitBlock
+{
+	struct alignas(64) Hot
+	{
+		std::atomic<int> state{Idle};
+		unsigned int job_tag{0};
+		clock_type::rep release_stamp{0};
+	};
+	struct alignas(64) Measures
+	{
+		uint64_t latency_sum{0};
+		uint64_t latency_max{0};
+	};
+
+	Hot & hot(size_t i) { return hot_blocks[i]; }
+	Measures & measures(size_t i) { return measure_blocks[i]; }
+
+	explicit SplitBlock(size_t n) : hot_blocks(new Hot[n]), measure_blocks(new Measures[n]) {}
+
+	std::unique_ptr<Hot[]> hot_blocks;
+	std::unique_ptr<Measures[]> measure_blocks;
+};
+
+static bool acquire(std::atomic<int> & state)
+{
+	while (true)
+	{
+		int s = state.load(std::memory_order_acquire);
+		if (s == Quit)
+			return false;
+		if (s != Pending)
+		{
+			rt::futex_wait(state, s);
+			continue;
+		}
+		if (state.compare_exchange_strong(s, Running, std::memory_order_acq_rel))
+			return true;
+	}
+}
+
+template <typename Layout>
+static std::vector<double> measure(size_t tasks, unsigned int frames)
+{
+	Layout layout(tasks);
+	std::vector<std::vector<double>> latency(tasks, std::vector<double>(frames));
+	std::atomic<size_t> completed{0};
+
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < tasks; ++t)
+	{
+		workers.emplace_back([&, t]() {
+			auto & H = layout.hot(t);
+			auto & M = layout.measures(t);
+			while (acquire(H.state))
+			{
+				uint64_t ns = clock_type::now().time_since_epoch().count() - H.release_stamp;
+				M.latency_sum += ns;
+				M.latency_max = std::max(M.latency_max, ns);
+				latency[t][H.job_tag] = ns / 1000.0;
+
+				int r = Running;
+				H.state.compare_exchange_strong(r, Idle, std::memory_order_acq_rel);
+				completed.fetch_add(1, std::memory_order_release);
+			}
+		});
+	}
+
+	// as in the executive: the releaser above all the workers, which share one priority
+	try
+	{
+		rt::this_thread::set_priority(rt::priority::rt_max);
+		for (auto & w : workers)
+			rt::set_priority(w, rt::priority::rt_max - 1);
+	}
+	catch (rt::permission_error &)
+	{
+		std::cerr << "warning: no permission for SCHED_FIFO, measuring with normal priority" << std::endl;
+	}
+
+	for (unsigned int f = 0; f < frames; ++f)
+	{
+		for (size_t t = 0; t < tasks; ++t)
+		{
+			auto & H = layout.hot(t);
+			H.job_tag = f;
+			H.release_stamp = clock_type::now().time_since_epoch().count();
+			H.state.store(Pending, std::memory_order_release);
+			rt::futex_wake(H.state);
+		}
+
+		// let the workers run, as the executive does by sleeping until the next frame
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+		while (completed.load(std::memory_order_acquire) != (f + 1) * tasks)
+			std::this_thread::yield();
+	}
+
+	for (size_t t = 0; t < tasks; ++t)
+	{
+		layout.hot(t).state.store(Quit, std::memory_order_release);
+		rt::futex_wake(layout.hot(t).state);
+	}
+	for (auto & w : workers)
+		w.join();
+
+	try
+	{
+		rt::this_thread::set_priority(rt::priority::not_rt);
+	}
+	catch (rt::permission_error &)
+	{
+	}
+
+	std::vector<double> all;
+	all.reserve(tasks * frames);
+	for (auto & v : latency)
+		all.insert(all.end(), v.begin(), v.end());
+	return all;
+}
+
+static void report(const char * name, std::vector<double> v)
+{
+	std::sort(v.begin(), v.end());
+
+	double sum = 0;
+	for (double x : v)
+		sum += x;
+
+	auto pct = [&](double p) { return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))]; };
+
+	std::cout << name
+		<< "\tmin " << v.front()
+		<< "\tavg " << sum / v.size()
+		<< "\tp50 " << pct(0.50)
+		<< "\tp99 " << pct(0.99)
+		<< "\tmax " << v.back()
+		<< "\t(us)" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+	size_t tasks = (argc > 1) ? std::atoi(argv[1]) : 64;
+	unsigned int frames = (argc > 2) ? std::atoi(argv[2]) : 2000;
+	if (tasks == 0)
+		tasks = 1;
+	if (frames == 0)
+		frames = 1;
+
+	std::cout << "release-to-start latency, " << tasks << " tasks x " << frames << " frames"
+		<< " (packed block " << sizeof(PackedBlock::Hot) << " bytes, split hot block "
+		<< sizeof(SplitBlock::Hot) << " bytes)" << std::endl;
+
+	report("packed", measure<PackedBlock>(tasks, frames));
+	report("split ", measure<SplitBlock>(tasks, frames));
+
+	return 0;
+}
@@ -38,4 +38,10 @@ void busy_wait(unsigned int millisec)
 	busy_wait_impl(100000, millisec * millisec_cycles);
 }
 
+// does a busy wait pause of the given microseconds (cycles scaled in 64 bit to keep the precision)
+void busy_wait_us(unsigned int microsec)
+{
+	busy_wait_impl(100000, static_cast<unsigned int>(static_cast<unsigned long long>(microsec) * millisec_cycles / 1000));
+}
+
 
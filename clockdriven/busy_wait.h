@@ -7,4 +7,7 @@ void busy_wait_init();
 // does a "busy wait", consuming the given amount of cpu time
 void busy_wait(unsigned int millisec);
 
+// as busy_wait(), with microsecond resolution (for sub-millisecond time quanta)
+void busy_wait_us(unsigned int microsec);
+
 #endif
@@ -0,0 +1,36 @@
+#include "exec_clock.h"
+#include "rt/futex.h"
+
+void RealClock::set_timer(rt::timer_backend backend_, std::chrono::nanoseconds spin_tail_) {
+    backend = backend_;
+    spin_tail = spin_tail_;
+}
+
+void RealClock::arm(time_point first, std::chrono::nanoseconds period) {
+    timer.reset(new rt::frame_timer(backend, spin_tail));
+    timer->arm(first, period);
+}
+
+unsigned long long RealClock::wait_next() {
+    return timer->wait_next();
+}
+
+void RealClock::sleep_until(time_point abs_time) {
+    // stessa precisione dei confini (clock_nanosleep + eventuale spin)
+    if (timer)
+        timer->sleep_until(abs_time);
+    else
+        rt::sleep_until(abs_time);
+}
+
+bool RealClock::wait_until(std::atomic<int> & word, int expected, time_point abs_time) {
+    return rt::futex_wait_until(word, expected, abs_time);
+}
+
+void RealClock::wake(std::atomic<int> & word) {
+    rt::futex_wake(word);
+}
+
+void RealClock::set_priority(std::thread & thread, uint16_t, const rt::priority & p) {
+    rt::set_priority(thread, p);
+}
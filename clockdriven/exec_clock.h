@@ -0,0 +1,66 @@
+#ifndef EXEC_CLOCK_H
+#define EXEC_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "rt/priority.h"
+#include "rt/timer.h"
+
+/* Sorgente del tempo e delle attese del thread executive: tempo corrente, confini dei frame,
+   attese (assolute o su futex), risveglio dei thread dei task e loro priorità.
+   RealClock usa steady_clock, rt::frame_timer, i futex e SCHED_FIFO; il simulatore (simulator.h)
+   la sostituisce con un orologio virtuale, senza cambiare la logica di exec_function. */
+class ExecClock {
+public:
+	typedef std::chrono::steady_clock::time_point time_point;
+
+	virtual ~ExecClock() = default;
+
+	virtual time_point now() = 0;
+
+	/* Confini dei frame: il primo in first, poi uno ogni period */
+	virtual void arm(time_point first, std::chrono::nanoseconds period) = 0;
+
+	/* Attende il prossimo confine; restituisce i confini persi prima di esso */
+	virtual unsigned long long wait_next() = 0;
+
+	virtual void sleep_until(time_point abs_time) = 0;
+
+	/* Attende che word sia diverso da expected, al più fino a abs_time; false alla scadenza */
+	virtual bool wait_until(std::atomic<int> & word, int expected, time_point abs_time) = 0;
+
+	/* Risveglia il thread in attesa su word (rilascio di un job) */
+	virtual void wake(std::atomic<int> & word) = 0;
+
+	/* Priorità del thread di un task:
+		thread: thread del task;
+		id: id del task nei record di trace (TRACE_NO_TASK per il server aperiodico);
+		p: nuova priorità.
+	*/
+	virtual void set_priority(std::thread & thread, uint16_t id, const rt::priority & p) = 0;
+};
+
+class RealClock final : public ExecClock {
+public:
+	/* Timer dei frame usato dalla prossima arm() */
+	void set_timer(rt::timer_backend backend, std::chrono::nanoseconds spin_tail);
+
+	time_point now() override { return std::chrono::steady_clock::now(); }
+	void arm(time_point first, std::chrono::nanoseconds period) override;
+	unsigned long long wait_next() override;
+	void sleep_until(time_point abs_time) override;
+	bool wait_until(std::atomic<int> & word, int expected, time_point abs_time) override;
+	void wake(std::atomic<int> & word) override;
+	void set_priority(std::thread & thread, uint16_t id, const rt::priority & p) override;
+
+private:
+	rt::timer_backend backend{rt::timer_backend::nanosleep};
+	std::chrono::nanoseconds spin_tail{0};
+	std::unique_ptr<rt::frame_timer> timer;
+};
+
+#endif // EXEC_CLOCK_H
@@ -1,288 +1,1592 @@
 #include "executive.h"
+#include "rt/futex.h"
+#include "rt/topology.h"
+#include "alloc_hook.h"
+#include "trace.h"
 #include <cassert>
-#include <iostream>
 #include <string>
-#define VERBOSE
+#include <algorithm>
+#include <ctime>
+#include <limits>
+#include <functional>
+#include <memory>
+#include <numeric>
+
+namespace {
+
+// tempo di CPU consumato dal thread chiamante, in ns
+uint64_t thread_cpu_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return to > from ? std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count() : 0;
+}
+
+// allocazioni e page fault del thread all'ultimo controllo di ArmConfig::check
+struct RtCheckpoint {
+    uint64_t allocations;
+    uint64_t page_faults;
+};
+thread_local RtCheckpoint rt_checkpoint{0, 0};
+
+// token del job in esecuzione nel thread (vuoto fuori dai job)
+thread_local Executive::CancelToken current_cancel;
+
+uint64_t thread_faults() {
+    rt::page_faults f = rt::thread_page_faults();
+    return f.minor + f.major;
+}
+
+// distanza minima (in frame, ciclica sull'iperperiodo) tra due rilasci di ogni task della tabella;
+// gap[tid] resta invariato per i task assenti (0 = nessun rilascio visto finora)
+void min_release_gaps(const ScheduleTable& S, std::vector<unsigned int>& gap) {
+    std::vector<long long> first(gap.size(), -1), last(gap.size(), -1);
+    auto update = [&](size_t tid, long long frames) {
+        unsigned int g = static_cast<unsigned int>(std::max(frames, 1ll));
+        gap[tid] = gap[tid] == 0 ? g : std::min(gap[tid], g);
+    };
+    for (size_t f = 0; f < S.num_frames; ++f) {
+        for (uint32_t j = S.frame_begin[f]; j < S.frame_begin[f + 1]; ++j) {
+            const size_t tid = S.jobs[j];
+            if (last[tid] < 0)
+                first[tid] = f;
+            else
+                update(tid, static_cast<long long>(f) - last[tid]);
+            last[tid] = f;
+        }
+    }
+    for (size_t tid = 0; tid < gap.size(); ++tid)
+        if (first[tid] >= 0)
+            update(tid, static_cast<long long>(S.num_frames) - last[tid] + first[tid]);
+}
+
+// true se nessun frame della tabella contiene due volte lo stesso task (un task ha un solo job per frame)
+bool frames_distinct(const ScheduleTable& S) {
+    std::vector<size_t> seen(S.num_tasks, S.num_frames);
+    for (size_t f = 0; f < S.num_frames; ++f) {
+        for (uint32_t j = S.frame_begin[f]; j < S.frame_begin[f + 1]; ++j) {
+            if (seen[S.jobs[j]] == f)
+                return false;
+            seen[S.jobs[j]] = f;
+        }
+    }
+    return true;
+}
+
+}
 
 
 Executive::Executive(size_t num_tasks,unsigned int frame_length_,unsigned int unit_duration_ms)
-    : tasks(num_tasks),frame_length(frame_length_),unit_time(unit_duration_ms)
+    : Executive(num_tasks, frame_length_, std::chrono::nanoseconds(std::chrono::milliseconds(unit_duration_ms)))
+{
+}
+
+Executive::Executive(size_t num_tasks,unsigned int frame_length_,std::chrono::nanoseconds unit_duration)
+    : tasks(num_tasks),task_config(num_tasks),task_control(num_tasks),task_measures(num_tasks),
+      frame_length(frame_length_),unit_time(unit_duration)
 {   
-    //setta tutti i task in Idle
-    for (auto& T : tasks) {
-        std::lock_guard<std::mutex> lg(T.state_mtx);
-        T.state = State::Idle;
-    }
+    //i task partono tutti in Idle (valore iniziale della parola di stato)
+    for (size_t tid = 0; tid < tasks.size(); ++tid)
+        tasks[tid].trace_id = static_cast<uint16_t>(tid);
+    ap_backlog.reserve(ap_queue.capacity());
+    ap_admitted.reserve(ap_queue.capacity() + 1);
+    dyn_frame_begin.push_back(0);
+    dyn_slack_prefix.push_back(0);
+    sync_schedule();
 }
 
-void Executive::set_periodic_task(size_t task_id,std::function<void()> periodic_task,unsigned int wcet)
+Executive::~Executive()
+{
+    if (exec_thread.joinable())
+        stop();
+    else
+        dismiss_workers();   // mai avviato (o già terminato): i worker attendono ancora un rilascio
+    wait();
+}
+
+void Executive::set_periodic_task(size_t task_id, Task periodic_task, OverrunPolicy policy)
+{
+    assert(static_schedule && sched.wcet); // WCET dallo schedule statico
+    set_periodic_task(task_id, std::move(periodic_task), sched.wcet[task_id], policy);
+}
+
+void Executive::set_periodic_task(size_t task_id,Task periodic_task,unsigned int wcet,OverrunPolicy policy)
 {
     assert(task_id < tasks.size()); //task_id valido
-    auto& T = tasks[task_id];
-    T.function = std::move(periodic_task);
-    T.wcet = wcet;
+    assert(!exec_thread.joinable()); // solo prima di start()
+    auto& C = task_config[task_id];
+    C.function = std::move(periodic_task);
+    C.wcet = wcet;
+    C.policy = policy;
+
+    // in modalità inline e pool (e in simulazione) il job non ha un thread dedicato
+    if (exec_mode != ExecMode::Threads || simulated())
+        return;
 
     // crea e lancia il thread
-    T.thread = std::thread(&Executive::task_function, std::ref(T));
-    {
-        std::lock_guard<std::mutex> lg(T.state_mtx);
-        T.state = State::Idle;
-    }
+    task_control[task_id].thread = std::thread(&Executive::task_function, this, task_id);
     // priorità minima iniziale
-    rt::set_priority(T.thread, rt::priority::rt_min);
+    set_priority(task_control[task_id], tasks[task_id].trace_id, rt::priority::rt_min);
 }
 
-void Executive::set_aperiodic_task(std::function<void()> aperiodic_task, unsigned int wcet) {
-    ap_T.function = std::move(aperiodic_task);
-    ap_T.wcet = wcet;
+void Executive::set_fallback_task(size_t task_id, Task fallback, unsigned int wcet)
+{
+    assert(task_id < tasks.size());
+    assert(!exec_thread.joinable());
+    auto& C = task_config[task_id];
+    C.fallback = std::move(fallback);
+    C.fallback_wcet = wcet;
+}
+
+void Executive::set_aperiodic_task(Task aperiodic_task, unsigned int wcet) {
+    set_aperiodic_task(ApTask([f = std::move(aperiodic_task)](void*) { f(); }), wcet);
+}
 
-    ap_T.thread = std::thread(&Executive::task_function, std::ref(ap_T));
-    {
-        std::lock_guard<std::mutex> lg(ap_T.state_mtx);
-        ap_T.state = State::Idle;
+void Executive::set_aperiodic_task(ApTask aperiodic_task, unsigned int wcet) {
+    // il task aperiodico "storico" è la classe 0
+    if (ap_classes.empty()) {
+        add_aperiodic_task(std::move(aperiodic_task), wcet);
+    } else {
+        assert(!exec_thread.joinable()); // solo prima di start()
+        ap_classes[0].function = std::move(aperiodic_task);
+        ap_classes[0].wcet = wcet;
     }
+}
 
-    rt::set_priority(ap_T.thread, rt::priority::rt_min);
+size_t Executive::add_aperiodic_task(ApTask aperiodic_task, unsigned int wcet, unsigned int rel_deadline) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    ApClass C;
+    C.function = std::move(aperiodic_task);
+    C.wcet = wcet;
+    C.rel_deadline = rel_deadline;
+    C.min_interarrival = 0;
+    C.sporadic = false;
+    C.last_arrival = std::chrono::steady_clock::time_point::min();
+    ap_classes.push_back(std::move(C));
+
+    // il server (thread di ap_T) viene creato alla prima classe registrata
+    if (!ap_control.thread.joinable() && !simulated()) {
+        ap_control.thread = std::thread(&Executive::ap_server_function, this);
+        set_priority(ap_control, ap_T.trace_id, rt::priority::rt_min);
+    }
+    return ap_classes.size() - 1;
 }
 
+size_t Executive::add_sporadic_task(ApTask sporadic_task, unsigned int wcet, unsigned int rel_deadline, unsigned int min_interarrival) {
+    assert(rel_deadline > 0);
+    size_t id = add_aperiodic_task(std::move(sporadic_task), wcet, rel_deadline);
+    ap_classes[id].min_interarrival = min_interarrival;
+    ap_classes[id].sporadic = true;
+    return id;
+}
+
+
+void Executive::set_aperiodic_queue(size_t capacity, ApOrder order) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    ap_queue.init(capacity);
+    ap_backlog.clear();
+    ap_backlog.reserve(ap_queue.capacity());
+    ap_admitted.clear();
+    ap_admitted.reserve(ap_queue.capacity() + 1);
+    ap_order = order;
+}
 
 void Executive::add_frame(std::vector<size_t> frame) {
+    assert(!exec_thread.joinable()); // solo prima di start(): i vettori dyn_* non vengono più riallocati
+    assert(!static_schedule); // non si mescola con set_schedule
+    const size_t first_job = dyn_jobs.size();
     for (auto id : frame) {
         assert(id < tasks.size());
+        // un task compare al più una volta per frame
+        assert(std::find(dyn_jobs.begin() + first_job, dyn_jobs.end(), id) == dyn_jobs.end());
+        dyn_jobs.push_back(static_cast<uint16_t>(id));
     }
-    frames.push_back(frame);
+    dyn_frame_begin.push_back(static_cast<uint32_t>(dyn_jobs.size()));
     
     // calcola slack time per il frame
     int slack_time = frame_length;
     for (size_t j = 0; j < frame.size(); j++) {
         size_t tid = frame[j];
-        auto& T = tasks[tid];
-        slack_time -= T.wcet;
+        slack_time -= task_config[tid].wcet;
     }
-#ifdef VERBOSE
-    std::cout << "[Exec] Frame " << frames.size() - 1 << ", con slack time: " << slack_time << std::endl;
-#endif
-    slack_times.push_back(slack_time);
+    dyn_slack.push_back(slack_time);
+    dyn_slack_prefix.push_back(dyn_slack_prefix.back() + std::max(slack_time, 0));
+    sync_schedule();
+}
+
+void Executive::set_schedule(const ScheduleTable & table) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    assert(dyn_jobs.empty() && dyn_slack.empty()); // non si mescola con add_frame
+    assert(table.num_tasks == tasks.size());
+    assert(frames_distinct(table));
+    sched = table;
+    static_schedule = true;
+    frame_length = table.frame_length;
+    if (table.wcet)
+        for (size_t tid = 0; tid < tasks.size(); ++tid)
+            task_config[tid].wcet = table.wcet[tid];
+}
+
+size_t Executive::add_mode(const ScheduleTable & table) {
+    assert(!exec_thread.joinable()); // solo prima di start(): i modi non vengono più riallocati
+    assert(table.num_tasks == tasks.size() && table.frame_length == frame_length && table.num_frames > 0);
+    assert(frames_distinct(table));
+    assert(modes.size() + 1 < 0xFFFF);
+    modes.push_back(table);
+    return modes.size();
+}
+
+void Executive::change_mode(size_t mode) {
+    assert(mode <= modes.size());
+    pending_mode.store(mode, std::memory_order_release);
+}
+
+size_t Executive::current_mode() const {
+    return static_cast<size_t>(mode_word.load(std::memory_order_acquire) & 0xFFFF);
+}
+
+const ScheduleTable& Executive::active_table() const {
+    return mode_table(current_mode());
+}
+
+void Executive::sync_schedule() {
+    // la tabella dinamica punta ai vettori dyn_* (che possono essere riallocati da add_frame)
+    sched.frame_length = frame_length;
+    sched.num_tasks = tasks.size();
+    sched.num_frames = dyn_slack.size();
+    sched.wcet = nullptr;
+    sched.jobs = dyn_jobs.data();
+    sched.frame_begin = dyn_frame_begin.data();
+    sched.slack = dyn_slack.data();
+    sched.slack_prefix = dyn_slack_prefix.data();
+}
+
+rt::priority Executive::plan_priority(size_t pos, bool ap_running) {
+    // priorità del job in posizione pos nel frame, calcolata a ogni rilascio (il "piano" di priorità):
+    // maxp - (pos+1), oppure maxp - (pos+2) con aperiodico attivo, limitate a min+1
+    return std::max(rt::priority::rt_max - static_cast<unsigned int>(pos + (ap_running ? 2 : 1)),
+                    rt::priority::rt_min + 1);
+}
+
+void Executive::set_execution_mode(ExecMode mode, size_t pool_workers) {
+    // in modalità inline e pool i task periodici non hanno un thread: va scelta prima di set_periodic_task
+    for (auto& C : task_control)
+        assert(!C.thread.joinable());
+    exec_mode = mode;
+    pool_size = pool_workers;
+}
+
+void Executive::set_arm(const ArmConfig & config) {
+    // lo stack dei worker viene pre-toccato alla loro creazione: va impostato prima di set_periodic_task
+    assert(!exec_thread.joinable());
+    for (auto& C : task_control)
+        assert(!C.thread.joinable());
+    assert(!ap_control.thread.joinable());
+    arm_config = config;
+    arm_enabled = true;
+}
+
+void Executive::arm_thread() {
+    // armamento del thread chiamante, dopo le sue allocazioni iniziali (es. il ring di trace)
+    if (!arm_enabled || simulated())
+        return;
+    if (arm_config.stack_prefault > 0)
+        rt::prefault_stack(arm_config.stack_prefault);
+    if (arm_config.check)
+        rt_checkpoint = RtCheckpoint{thread_allocations(), thread_faults()};
+}
+
+void Executive::rt_check(uint16_t trace_id) {
+    // debug: allocazioni e page fault del thread chiamante dall'ultimo controllo (una getrusage)
+    if (!arm_enabled || !arm_config.check || simulated())
+        return;
+    uint64_t allocations = thread_allocations();
+    uint64_t faults = thread_faults();
+    if (allocations == rt_checkpoint.allocations && faults == rt_checkpoint.page_faults)
+        return;
+
+    rt_allocations.fetch_add(allocations - rt_checkpoint.allocations, std::memory_order_relaxed);
+    rt_page_faults.fetch_add(faults - rt_checkpoint.page_faults, std::memory_order_relaxed);
+    Tracer::global().emit(TraceEvent::RtViolation, trace_id, abs_frame.load(std::memory_order_relaxed),
+                          static_cast<int32_t>((allocations - rt_checkpoint.allocations) + (faults - rt_checkpoint.page_faults)));
+    rt_checkpoint = RtCheckpoint{allocations, faults};
+    assert(!"allocazione o page fault in un thread dell'executive dopo l'armamento");
+}
+
+void Executive::set_budget_enforcement(bool enabled) {
+    // il timer del budget viene creato da ogni worker all'avvio: va impostato prima di set_periodic_task
+    for (auto& C : task_control)
+        assert(!C.thread.joinable());
+    assert(!exec_thread.joinable());
+    budget_enforcement = enabled;
+}
+
+void Executive::set_policy(SchedPolicy policy) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    sched_policy = policy;
+}
+
+void Executive::set_task_timing(size_t task_id, unsigned int period, unsigned int deadline) {
+    assert(task_id < tasks.size());
+    assert(!exec_thread.joinable()); // solo prima di start()
+    if (deadline == 0)
+        deadline = period;
+    // i rilasci e le verifiche delle deadline avvengono solo ai tick
+    assert(period > 0 && period % frame_length == 0);
+    assert(deadline <= period && deadline % frame_length == 0);
+    task_config[task_id].period = period;
+    task_config[task_id].deadline = deadline;
+}
+
+void Executive::prepare_priority_driven() {
+    // politiche a priorità: tutti i task rilasciati al tick 0, iperperiodo in tick, priorità RM
+    // (per periodo, poi deadline); i vettori non vengono più riallocati durante l'esecuzione
+    assert(exec_mode == ExecMode::Threads && modes.empty());
+    assert(std::none_of(ap_classes.begin(), ap_classes.end(), [](const ApClass& C) { return C.sporadic; }));
+    std::vector<uint32_t> order;
+    release_heap.clear();
+    hyperperiod_ticks = 1;
+    for (size_t tid = 0; tid < tasks.size(); ++tid) {
+        const TaskConfig& C = task_config[tid];
+        if (!C.function)
+            continue;
+        assert(C.period > 0); // set_task_timing
+        release_heap.emplace_back(0, static_cast<uint32_t>(tid));
+        order.push_back(static_cast<uint32_t>(tid));
+        hyperperiod_ticks = std::lcm(hyperperiod_ticks, static_cast<unsigned long long>(C.period / frame_length));
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        const TaskConfig& A = task_config[a];
+        const TaskConfig& B = task_config[b];
+        if (A.period != B.period)
+            return A.period < B.period;
+        return A.deadline != B.deadline ? A.deadline < B.deadline : a < b;
+    });
+    rm_priority.assign(tasks.size(), rt::priority::rt_min + 1);
+    for (size_t r = 0; r < order.size(); ++r)
+        rm_priority[order[r]] = plan_priority(r, false);
+
+    prio_active.clear();
+    prio_active.reserve(tasks.size());
+    prio_released.clear();
+    prio_released.reserve(tasks.size());
+    prio_rank.clear();
+    prio_rank.reserve(tasks.size());
+}
+
+void Executive::set_sched_backend(SchedBackend backend) {
+    set_sched_backend(backend, DeadlineConfig());
+}
+
+void Executive::set_sched_backend(SchedBackend backend, const DeadlineConfig & config) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    sched_backend = backend;
+    deadline_config = config;
+}
+
+bool Executive::deadline_requested() const {
+    // il kernel ammette SCHED_DEADLINE solo su thread non vincolati a un sottoinsieme dei core
+    return sched_backend == SchedBackend::Deadline && exec_mode == ExecMode::Threads
+           && !cpu_affinity.any() && !simulated();
+}
+
+bool Executive::reserve(TaskControl& C, const rt::deadline_params& p) {
+    // prenotazione di un worker: se rifiutata il thread resta in SCHED_FIFO, con il piano di priorità
+    while (C.tid.load(std::memory_order_acquire) == 0)
+        std::this_thread::yield();
+    try {
+        rt::set_deadline(C.tid.load(std::memory_order_acquire), p);
+        C.deadline = true;
+    } catch (rt::permission_error&) {
+    }
+    return C.deadline;
+}
+
+void Executive::setup_deadline() {
+    // prenotazioni SCHED_DEADLINE prima del primo frame (il thread executive attende su sched_setup):
+    // prima l'executive, che deve poter sempre interrompere i job, poi i task, infine il server
+    // con la banda rimasta. I task passano tutti o nessuno: uno solo in SCHED_DEADLINE precederebbe
+    // sempre quelli in SCHED_FIFO, contro l'ordine del piano; senza la prenotazione dell'executive
+    // o di tutti i task si resta interamente su Fifo
+    typedef std::chrono::nanoseconds ns;
+    const ns frame = frame_length * unit_time;
+    const ns min_runtime(1024);   // minimo accettato dal kernel
+
+    while (exec_tid.load(std::memory_order_acquire) == 0)
+        std::this_thread::yield();
+    const ns exec_runtime = deadline_config.exec_runtime.count() > 0 ? deadline_config.exec_runtime : frame / 20;
+    try {
+        rt::set_deadline(exec_tid.load(std::memory_order_acquire),
+                         rt::deadline_params{exec_runtime, exec_runtime, frame, false});
+        exec_deadline = true;
+    } catch (rt::permission_error&) {
+        exec_deadline = false;
+    }
+
+    if (exec_deadline) {
+        // periodo di un task: il suo periodo (RM, EDF) o la distanza minima tra due suoi rilasci
+        // nelle tabelle di tutti i modi, con deadline di un frame (Cyclic)
+        std::vector<unsigned int> gap(tasks.size(), 0);
+        if (sched_policy == SchedPolicy::Cyclic) {
+            for (size_t m = 0; m <= modes.size(); ++m)
+                min_release_gaps(mode_table(m), gap);
+        } else {
+            for (size_t tid = 0; tid < tasks.size(); ++tid)
+                gap[tid] = task_config[tid].period / frame_length;
+        }
+
+        double bandwidth = static_cast<double>(exec_runtime.count()) / frame.count();
+        bool all_tasks = true;
+        for (size_t tid = 0; tid < tasks.size() && all_tasks; ++tid) {
+            auto& C = task_control[tid];
+            const ns runtime = task_config[tid].wcet * unit_time;
+            if (!C.thread.joinable() || gap[tid] == 0)
+                continue;
+            const ns period = gap[tid] * frame;
+            const ns deadline = sched_policy == SchedPolicy::Cyclic ? frame : task_config[tid].deadline * unit_time;
+            all_tasks = runtime >= min_runtime && reserve(C, rt::deadline_params{runtime, deadline, period, false});
+            bandwidth += static_cast<double>(runtime.count()) / period.count();
+        }
+
+        // un task non ammesso (o con WCET 0): i task già prenotati e l'executive tornano in SCHED_FIFO
+        if (!all_tasks) {
+            for (auto& C : task_control) {
+                if (!C.deadline)
+                    continue;
+                rt::set_priority(C.thread, C.priority);
+                C.deadline = false;
+            }
+            rt::set_priority(exec_thread, rt::priority::rt_max);
+            exec_deadline = false;
+        }
+
+        // server aperiodico: constant-bandwidth server con un frame di periodo, che recupera
+        // anche la banda non usata dai task (SCHED_FLAG_RECLAIM); di default prende la banda che
+        // resta entro il 95% ammesso dal kernel, dimezzandola finché non viene ammessa (il kernel
+        // può riservarne una parte ad altro, es. al server dei thread SCHED_OTHER)
+        if (exec_deadline && ap_control.thread.joinable()) {
+            const bool fixed = deadline_config.server_runtime.count() > 0;
+            ns runtime = fixed ? std::min(deadline_config.server_runtime, frame)
+                               : ns(static_cast<long long>((0.95 - bandwidth) * frame.count()));
+            while (runtime >= min_runtime && !reserve(ap_control, rt::deadline_params{runtime, frame, frame, true})
+                   && !fixed)
+                runtime /= 2;
+        }
+    }
+
+    // thread rimasti in SCHED_FIFO nonostante il backend Deadline
+    deadline_fallbacks = !exec_deadline;
+    for (auto& C : task_control)
+        deadline_fallbacks += C.thread.joinable() && !C.deadline;
+    deadline_fallbacks += ap_control.thread.joinable() && !ap_control.deadline;
+
+    sched_setup.store(1, std::memory_order_release);
+    rt::futex_wake(sched_setup);
+}
+
+void Executive::set_frame_timer(rt::timer_backend backend, std::chrono::nanoseconds spin_tail) {
+    real_clock.set_timer(backend, spin_tail);
+}
+
+void Executive::set_clock(ExecClock & clock_) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    for (auto& C : task_control)
+        assert(!C.thread.joinable());
+    assert(!ap_control.thread.joinable());
+    clock = &clock_;
+    assert(!simulated() || exec_mode == ExecMode::Threads);
+}
+
+void Executive::set_hyperperiod_limit(unsigned long long hyperperiods) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    hyperperiod_limit = hyperperiods;
+}
+
+void Executive::set_affinity(const rt::cpu_set & cpus) {
+    assert(!exec_thread.joinable()); // solo prima di start()
+    cpu_affinity = cpus;
 }
 
 void Executive::start() {
-    exec_thread = std::thread(&Executive::exec_function, this);
-    // thread manager con priorità massima
-    rt::set_priority(exec_thread, rt::priority::rt_max);
+    // l'istante di inizio va preso dopo l'armamento: il blocco della memoria può durare molti frame
+    arm();
+    start(clock->now());
+}
+
+void Executive::arm() {
+    // armamento: da qui in poi schedule e task sono fissati (vedi le assert dei metodi [INIT]);
+    // le pagine già toccate (stack dei worker, tabelle, istogrammi, ring di trace) restano in RAM
+    if (armed || !arm_enabled || simulated())
+        return;
+    armed = true;
+    rt::reserve_heap(arm_config.heap_reserve);
+    memory_locked = arm_config.memory_lock != rt::memory_lock::none && rt::lock_memory(arm_config.memory_lock);
+}
+
+void Executive::start(std::chrono::steady_clock::time_point start_time) {
+    // la politica Fallback richiede la funzione di riserva (set_fallback_task)
+    assert(std::all_of(task_config.begin(), task_config.end(), [](const TaskConfig& C) {
+        return C.policy != OverrunPolicy::Fallback || static_cast<bool>(C.fallback);
+    }));
+    if (sched_policy != SchedPolicy::Cyclic)
+        prepare_priority_driven();
+
+    // armamento, se non già eseguito prima di scegliere start_time (vedi arm())
+    arm();
+
+    // vincola tutti i thread ai core assegnati, prima che venga rilasciato qualsiasi job
+    if (cpu_affinity.any()) {
+        for (auto& C : task_control)
+            if (C.thread.joinable())
+                rt::set_affinity(C.thread, cpu_affinity);
+        if (ap_control.thread.joinable())
+            rt::set_affinity(ap_control.thread, cpu_affinity);
+    }
+
+    if (exec_mode == ExecMode::Pool)
+        start_pool();
+
+    exec_thread = std::thread(&Executive::exec_function, this, start_time);
+    // in simulazione il thread executive è un thread normale: i tempi sono virtuali
+    if (simulated())
+        return;
+    if (cpu_affinity.any())
+        rt::set_affinity(exec_thread, cpu_affinity);
+    if (deadline_requested())
+        setup_deadline();
+    // thread manager con priorità massima (se non è già in SCHED_DEADLINE)
+    if (!exec_deadline)
+        rt::set_priority(exec_thread, rt::priority::rt_max);
+}
+
+void Executive::start_pool() {
+    // un worker per core ammesso (o il numero richiesto), ciascuno vincolato a un solo core
+    std::vector<size_t> cpus = cpu_affinity.any() ? cpu_affinity.cpus() : rt::online_cpus().cpus();
+    if (cpus.empty())
+        cpus.push_back(0);
+    size_t n = pool_size ? pool_size : cpus.size();
+
+    std::vector<PoolWorker> workers(n);
+    pool.swap(workers);
+    for (size_t w = 0; w < n; ++w) {
+        PoolWorker& W = pool[w];
+        W.thread = std::thread(&Executive::pool_function, this, w);
+        rt::cpu_set core;
+        core.set(cpus[w % cpus.size()]);
+        rt::set_affinity(W.thread, core);
+        rt::set_priority(W.thread, rt::priority::rt_min);
+        W.priority = rt::priority::rt_min;
+    }
+}
+
+Executive::LatencyStats Executive::summarize(const Histogram& h) {
+    typedef std::chrono::nanoseconds ns;
+    LatencyStats l;
+    l.count = h.count();
+    l.min = ns(h.min());
+    l.mean = ns(static_cast<long long>(h.mean()));
+    l.max = ns(h.max());
+    l.p50 = ns(h.percentile(50.0));
+    l.p90 = ns(h.percentile(90.0));
+    l.p99 = ns(h.percentile(99.0));
+    l.p999 = ns(h.percentile(99.9));
+    l.p9999 = ns(h.percentile(99.99));
+    return l;
+}
+
+Executive::Stats Executive::stats() const {
+    Stats st;
+    st.tasks.reserve(tasks.size());
+    for (size_t tid = 0; tid < tasks.size(); ++tid) {
+        const TaskMeasures& M = task_measures[tid];
+        TaskStats ts;
+        ts.release_latency = summarize(M.latency_hist);
+        ts.release_jitter = summarize(M.jitter_hist);
+        ts.response_time = summarize(M.response_hist);
+        ts.exec_time = summarize(M.exec_hist);
+        ts.deadline_misses = task_control[tid].deadline_misses.load(std::memory_order_relaxed);
+        ts.budget_overruns = M.budget_overruns.load(std::memory_order_relaxed);
+        ts.overrun_policy = task_config[tid].policy;
+        ts.skipped = task_control[tid].skipped.load(std::memory_order_relaxed);
+        ts.cancelled = task_control[tid].cancelled.load(std::memory_order_relaxed);
+        ts.fallbacks = task_control[tid].fallbacks.load(std::memory_order_relaxed);
+        ts.sched_deadline = task_control[tid].deadline;
+        st.tasks.push_back(ts);
+    }
+    st.ap_response_time = summarize(ap_response_hist);
+    st.wakeup_lateness = summarize(wakeup_hist);
+    st.timer_overruns = timer_overruns.load(std::memory_order_relaxed);
+    st.exec_cpu_per_frame = summarize(exec_cpu_hist);
+    st.syscalls_per_frame = syscall_hist.mean();
+    st.max_syscalls_per_frame = syscall_hist.max();
+    st.frames = frames_run.load(std::memory_order_relaxed);
+    st.memory_locked = memory_locked;
+    st.rt_allocations = rt_allocations.load(std::memory_order_relaxed);
+    st.rt_page_faults = rt_page_faults.load(std::memory_order_relaxed);
+    st.sched_deadline = exec_deadline;
+    st.ap_sched_deadline = ap_control.deadline;
+    st.deadline_fallbacks = deadline_fallbacks;
+    return st;
+}
+
+double Executive::utilization() const {
+    if (sched_policy != SchedPolicy::Cyclic) {
+        double u = 0.0;
+        for (const TaskConfig& C : task_config)
+            if (C.period > 0)
+                u += static_cast<double>(C.wcet) / C.period;
+        return u;
+    }
+    const ScheduleTable& S = active_table();
+    if (S.num_frames == 0)
+        return 0.0;
+    double busy = 0.0;
+    for (size_t f = 0; f < S.num_frames; ++f)
+        busy += frame_length - std::max(S.slack[f], 0);
+    return busy / (S.num_frames * frame_length);
+}
+
+double Executive::mean_slack() const {
+    if (sched_policy != SchedPolicy::Cyclic)
+        return frame_length * (1.0 - utilization());
+    const ScheduleTable& S = active_table();
+    if (S.num_frames == 0)
+        return 0.0;
+    return static_cast<double>(S.slack_prefix[S.num_frames]) / S.num_frames;
 }
 
 void Executive::wait() {
     if (exec_thread.joinable())
         exec_thread.join();
+    if (!stopping.load(std::memory_order_acquire))
+        return;
+
+    // i worker escono dopo il job in corso (vedi dismiss_workers)
+    for (auto& C : task_control)
+        if (C.thread.joinable())
+            C.thread.join();
+    if (ap_control.thread.joinable())
+        ap_control.thread.join();
+    for (auto& W : pool)
+        if (W.thread.joinable())
+            W.thread.join();
 }
 
-void Executive::ap_task_request() {
-    // Segnala la presenza di una richiesta aperiodica
-    {
-    std::lock_guard<std::mutex> lg(ap_request_mtx);
-    ap_request_pending = true;
+void Executive::stop() {
+    stop_requested.store(true, std::memory_order_release);
+}
+
+void Executive::dismiss_workers() {
+    // Stopped sostituisce qualsiasi stato: un job in corso termina, poi il worker esce
+    stopping.store(true, std::memory_order_release);
+    if (simulated())
+        return;
+    for (auto& T : tasks) {
+        T.state.store(static_cast<int>(State::Stopped), std::memory_order_release);
+        rt::futex_wake(T.state);
     }
-#ifdef VERBOSE
-    std::cout << "[AP] Richiesta aperiodico ricevuta\n";
-#endif
+    ap_T.state.store(static_cast<int>(State::Stopped), std::memory_order_release);
+    rt::futex_wake(ap_T.state);
+    pool_cursor.store(POOL_CLOSED, std::memory_order_release);
+    pool_epoch.fetch_add(1, std::memory_order_release);
+    rt::futex_wake(pool_epoch, std::numeric_limits<int>::max());
+}
+
+bool Executive::ap_task_request(void* arg, unsigned int rel_deadline) {
+    assert(!ap_classes.empty());
+    ApJob job;
+    job.class_id = 0;
+    job.arg = arg;
+    job.arrival = clock->now();
+    if (rel_deadline == 0)
+        rel_deadline = ap_classes[0].rel_deadline;
+    job.deadline = (rel_deadline == 0) ? std::chrono::steady_clock::time_point::max()
+                                       : job.arrival + rel_deadline * unit_time;
+    job.sporadic = ap_classes[0].sporadic;
+    return ap_push(job);
+}
+
+bool Executive::ap_task_request(size_t class_id, void* arg) {
+    assert(class_id < ap_classes.size());
+    const ApClass& C = ap_classes[class_id];
+    ApJob job;
+    job.class_id = class_id;
+    job.arg = arg;
+    job.arrival = clock->now();
+    job.deadline = (C.rel_deadline == 0) ? std::chrono::steady_clock::time_point::max()
+                                         : job.arrival + C.rel_deadline * unit_time;
+    job.sporadic = C.sporadic;
+    return ap_push(job);
+}
+
+bool Executive::ap_push(const ApJob& job) {
+    // Accoda la richiesta: nessun lock, numero di sequenza e accettazione li gestisce il server
+    if (!ap_queue.push(job)) {
+        ap_rejected_total.fetch_add(1, std::memory_order_relaxed);
+        Tracer::global().emit(TraceEvent::ApRequest, job.class_id, abs_frame.load(std::memory_order_relaxed), 0);
+        return false;
+    }
+    Tracer::global().emit(TraceEvent::ApRequest, job.class_id, abs_frame.load(std::memory_order_relaxed), 1);
+    return true;
+}
+
+Executive::ApCounters Executive::ap_counters() const {
+    ApCounters c;
+    c.queue_depth = ap_last_depth.load(std::memory_order_relaxed);
+    c.rejected = ap_last_rejected.load(std::memory_order_relaxed);
+    c.not_admitted = ap_last_not_admitted.load(std::memory_order_relaxed);
+    c.served = ap_served_total.load(std::memory_order_relaxed);
+    c.reclaimed = std::chrono::nanoseconds(reclaimed_last.load(std::memory_order_relaxed));
+    c.reclaimed_total = std::chrono::nanoseconds(reclaimed_total.load(std::memory_order_relaxed));
+    return c;
 }
-    
 
+bool Executive::ap_job_later(const ApJob& a, const ApJob& b) const {
+    // confronto per il heap di std::push_heap: in cima la richiesta da servire per prima
+    if (a.sporadic != b.sporadic)
+        return !a.sporadic;
+    if ((a.sporadic || ap_order == ApOrder::Deadline) && a.deadline != b.deadline)
+        return a.deadline > b.deadline;
+    return a.seq > b.seq;
+}
+
+std::chrono::nanoseconds Executive::slack_until(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point deadline) const {
+    // slack (all'inizio di ogni frame) disponibile al server nell'intervallo [now, deadline]
+    // (secondo il modo attivo, i cui frame sono numerati dal suo primo frame)
+    typedef std::chrono::nanoseconds ns;
+    const unsigned long long word = mode_word.load(std::memory_order_acquire);
+    const ScheduleTable& S = mode_table(word & 0xFFFF);
+    const long long base = static_cast<long long>(word >> 16);
+    const long long F = S.num_frames;
+    const ns L = frame_length * unit_time;
+    if (F == 0 || deadline <= now)
+        return ns(0);
+    const std::chrono::steady_clock::time_point origin = hyperperiod_origin + base * L;
+
+    // slack cumulativo (in quanti) dei frame [0, n)
+    auto cumulative = [&](long long n) {
+        return (n / F) * S.slack_prefix[F] + S.slack_prefix[n % F];
+    };
+    // parte della finestra di slack del frame f che cade in [now, deadline]
+    auto overlap = [&](long long f) {
+        std::chrono::steady_clock::time_point ws = origin + f * L;
+        std::chrono::steady_clock::time_point we = ws + (cumulative(f + 1) - cumulative(f)) * unit_time;
+        auto from = std::max(ws, now);
+        auto to = std::min(we, deadline);
+        return to > from ? std::chrono::duration_cast<ns>(to - from) : ns(0);
+    };
+
+    long long first = std::max(static_cast<long long>(abs_frame.load(std::memory_order_acquire)) - base, 0ll);
+    long long last = (deadline - origin) / L;
+    if (last <= first)
+        return overlap(first);
+
+    // frame iniziale e finale parziali, quelli intermedi interi
+    ns total = overlap(first) + overlap(last);
+    total += (cumulative(last) - cumulative(first + 1)) * unit_time;
+    return total;
+}
+
+bool Executive::ap_admit(const ApJob& job, std::chrono::steady_clock::time_point now) {
+    // test di accettazione: servendo i sporadici per deadline, ognuno deve trovare abbastanza slack;
+    // il server non è preemptive, quindi un job soft in servizio va prima di tutti (blocco)
+    auto pos = std::upper_bound(ap_admitted.begin(), ap_admitted.end(), job,
+        [](const ApJob& a, const ApJob& b) { return a.deadline < b.deadline; });
+
+    std::chrono::nanoseconds demand = ap_blocking;
+    auto check = [&](const ApJob& j) {
+        demand += ap_classes[j.class_id].wcet * unit_time;
+        return demand <= slack_until(now, j.deadline);
+    };
+    for (auto it = ap_admitted.begin(); it != pos; ++it)
+        demand += ap_classes[it->class_id].wcet * unit_time;
+    if (!check(job))
+        return false;
+    for (auto it = pos; it != ap_admitted.end(); ++it)
+        if (!check(*it))
+            return false;
+
+    ap_admitted.insert(pos, job);
+    return true;
+}
 
-void Executive::task_function(TaskData& T) {
-   while(true) {
-        std::unique_lock<std::mutex> lk(T.state_mtx);
-        while(!(T.state == State::Pending)) {
-            T.cv.wait(lk);
+void Executive::drain_ap_queue() {
+    // sposta le richieste dalla coda MPSC al backlog ordinato, finché c'è spazio
+    auto later = [this](const ApJob& a, const ApJob& b) { return ap_job_later(a, b); };
+    auto now = clock->now();
+    ApJob job;
+    while (ap_backlog.size() < ap_backlog.capacity() && ap_queue.pop(job)) {
+        job.seq = ap_seq++;
+        if (job.sporadic) {
+            ApClass& C = ap_classes[job.class_id];
+            bool too_early = C.last_arrival != std::chrono::steady_clock::time_point::min()
+                             && job.arrival - C.last_arrival < C.min_interarrival * unit_time;
+            if (too_early || !ap_admit(job, now)) {
+                ap_not_admitted_total.fetch_add(1, std::memory_order_relaxed);
+                Tracer::global().emit(TraceEvent::ApNotAdmitted, job.class_id, abs_frame.load(std::memory_order_relaxed));
+                continue;
+            }
+            C.last_arrival = job.arrival;
+        }
+        ap_backlog.push_back(job);
+        std::push_heap(ap_backlog.begin(), ap_backlog.end(), later);
+    }
+    ap_backlog_size.store(ap_backlog.size(), std::memory_order_release);
+}
+
+void Executive::ap_server_function() {
+    ap_control.tid.store(rt::this_thread::get_tid(), std::memory_order_release);
+    Tracer::global().attach_thread();
+    arm_thread();
+    ApJob job;
+    while (wait_release(ap_T)) {
+        // serve le richieste una dopo l'altra finché ce ne sono: la priorità la decide l'executive
+        while (!stopping.load(std::memory_order_relaxed) && ap_next(job)) {
+            ap_classes[job.class_id].function(job.arg);
+            ap_finish(job);
+            rt_check(ap_T.trace_id);
         }
-        T.state = State::Running;
-        lk.unlock();
-#ifdef VERBOSE
-        rt::priority current_priority = rt::get_priority(T.thread);
-        std::cout << "[Task] Running task priority: " << current_priority << std::endl;
-#endif
-        // esegue il task
-        T.function();
-
-        // torna idle
-        {
-            std::lock_guard<std::mutex> lg(T.state_mtx);
-            T.state = State::Idle;
+
+        job_done(ap_T);
+    }
+}
+
+bool Executive::ap_next(ApJob& job) {
+    // prossima richiesta da servire (false se non ce ne sono)
+    auto later = [this](const ApJob& a, const ApJob& b) { return ap_job_later(a, b); };
+    drain_ap_queue();
+    if (ap_backlog.empty())
+        return false;
+
+    std::pop_heap(ap_backlog.begin(), ap_backlog.end(), later);
+    job = ap_backlog.back();
+    ap_backlog.pop_back();
+    ap_backlog_size.store(ap_backlog.size(), std::memory_order_release);
+    // un job sporadico in servizio è già tra gli accettati; uno soft blocca fino al suo WCET
+    ap_blocking = job.sporadic ? std::chrono::nanoseconds(0) : ap_classes[job.class_id].wcet * unit_time;
+
+    Tracer::global().emit(TraceEvent::JobStart, TRACE_NO_TASK, abs_frame.load(std::memory_order_relaxed), job.class_id);
+    return true;
+}
+
+void Executive::ap_finish(const ApJob& job) {
+    ap_blocking = std::chrono::nanoseconds(0);
+    ap_served_total.fetch_add(1, std::memory_order_relaxed);
+    Tracer::global().emit(TraceEvent::JobEnd, TRACE_NO_TASK, abs_frame.load(std::memory_order_relaxed), job.class_id);
+    auto now = clock->now();
+    ap_response_hist.record(elapsed_ns(job.arrival, now));
+
+    if (now > job.deadline)
+        Tracer::global().emit(TraceEvent::DeadlineMiss, TRACE_NO_TASK, abs_frame.load(std::memory_order_relaxed), job.class_id);
+
+    if (job.sporadic) {
+        for (auto it = ap_admitted.begin(); it != ap_admitted.end(); ++it) {
+            if (it->seq == job.seq) {
+                ap_admitted.erase(it);
+                break;
+            }
         }
+    }
+}
 
+Executive::State Executive::get_state(const TaskData& T) {
+    return static_cast<State>(T.state.load(std::memory_order_acquire));
+}
+
+void Executive::set_priority(TaskControl& C, uint16_t trace_id, const rt::priority& p) {
+    // evita la syscall se il thread ha già la priorità richiesta; i thread SCHED_DEADLINE li ordina il kernel
+    if (C.deadline)
+        return;
+    if (C.priority != p) {
+        clock->set_priority(C.thread, trace_id, p);
+        ++exec_syscalls;
+        C.priority = p;
+        Tracer::global().emit(TraceEvent::PriorityChange, trace_id, abs_frame.load(std::memory_order_relaxed),
+                              p - rt::priority::not_rt);
+    }
+}
+
+bool Executive::decide_release(size_t tid) {
+    // decide se il job del task va rilasciato nel frame (solo thread executive): no se è da saltare
+    // per un deadline miss (Skip) o se il job precedente in ritardo non è ancora terminato, con ogni
+    // politica: rilasciarlo sovrascriverebbe i dati del job in corso (arm_job) e, nel pool, lo farebbe
+    // eseguire a un secondo worker
+    auto& C = task_control[tid];
+    if (C.skip_count > 0) {
+        --C.skip_count;
+        C.skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (get_state(tasks[tid]) != State::Idle) {
+        C.skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+Executive::CancelToken Executive::cancel_token() {
+    return current_cancel;
+}
+
+void Executive::release(TaskData& T) {
+    // rilascio: una store sulla parola di stato e un solo wake del worker
+    T.state.store(static_cast<int>(State::Pending), std::memory_order_release);
+    clock->wake(T.state);
+}
+
+bool Executive::wait_release(TaskData& T) {
+    // attende il rilascio (Pending) e lo prende in carico (Pending -> Running); false alla terminazione
+    const int pending = static_cast<int>(State::Pending);
+    while (true) {
+        int s = T.state.load(std::memory_order_acquire);
+        if (s == static_cast<int>(State::Stopped))
+            return false;
+        if (s != pending) {
+            rt::futex_wait(T.state, s);
+            continue;
+        }
+        if (T.state.compare_exchange_strong(s, static_cast<int>(State::Running), std::memory_order_acq_rel))
+            return true;
+    }
+}
+
+void Executive::job_done(TaskData& T) {
+    // torna idle; se nel frattempo è arrivato un nuovo rilascio (Pending) resta tale
+    int r = static_cast<int>(State::Running);
+    T.state.compare_exchange_strong(r, static_cast<int>(State::Idle), std::memory_order_acq_rel);
+}
+
+void Executive::job_completed(unsigned int tag) {
+    // scala i job rimanenti solo se il job appartiene al frame corrente (non a uno in ritardo)
+    unsigned long long cur = frame_jobs.load(std::memory_order_acquire);
+    while ((cur >> 32) == tag && (cur & 0xFFFFFFFFull) > 0) {
+        if (frame_jobs.compare_exchange_weak(cur, cur - 1, std::memory_order_acq_rel)) {
+            if ((cur & 0xFFFFFFFFull) == 1) {
+                // ultimo job del frame: sveglia l'executive per recuperare lo slack
+                frame_complete.fetch_add(1, std::memory_order_release);
+                rt::futex_wake(frame_complete);
+            }
+            break;
+        }
+    }
+}
+
+bool Executive::run_job(size_t tid, rt::cpu_budget* budget) {
+    // esegue il task, misurando jitter di rilascio, tempo di risposta e tempo di CPU;
+    // con il budget attivo restituisce true se il job ha superato il WCET (e si è già abbassato)
+    TaskData& T = tasks[tid];
+    TaskMeasures& M = task_measures[tid];
+    const TaskConfig& cfg = task_config[tid];
+    const unsigned int wcet = T.fallback ? cfg.fallback_wcet : cfg.wcet;
+    // con Abort e Fallback anche l'esaurimento del budget chiede l'annullamento del job
+    current_cancel.flag = &T.cancel;
+    current_cancel.budget = (cfg.policy == OverrunPolicy::Abort || cfg.policy == OverrunPolicy::Fallback)
+                            ? &T.over_budget : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t cpu_start = thread_cpu_ns();
+    Tracer::global().emit(TraceEvent::JobStart, T.trace_id, abs_frame.load(std::memory_order_relaxed));
+    // in SCHED_DEADLINE il budget lo applica il kernel: il timer conta solo il superamento
+    if (budget && wcet > 0)
+        budget->start(wcet * unit_time, task_control[tid].deadline ? rt::priority::not_rt : rt::priority::rt_min + 1,
+                      &T.over_budget);
+    if (T.fallback)
+        cfg.fallback();
+    else
+        cfg.function();
+    bool over = budget && budget->stop();
+    current_cancel = CancelToken();
+    Tracer::global().emit(TraceEvent::JobEnd, T.trace_id, abs_frame.load(std::memory_order_relaxed));
+    uint64_t cpu_end = thread_cpu_ns();
+    auto end = std::chrono::steady_clock::now();
+
+    M.latency_hist.record(elapsed_ns(T.release_stamp, start));
+    M.jitter_hist.record(elapsed_ns(T.release_time, start));
+    M.response_hist.record(elapsed_ns(T.release_time, end));
+    M.exec_hist.record(cpu_end - cpu_start);
+
+    if (over) {
+        M.budget_overruns.fetch_add(1, std::memory_order_relaxed);
+        Tracer::global().emit(TraceEvent::BudgetOverrun, T.trace_id, abs_frame.load(std::memory_order_relaxed));
+    }
+    return over;
+}
+
+void Executive::task_function(size_t tid) {
+   TaskData& T = tasks[tid];
+   task_control[tid].tid.store(rt::this_thread::get_tid(), std::memory_order_release);
+   // timer sul tempo di CPU del thread, per il budget dei job
+   std::unique_ptr<rt::cpu_budget> budget;
+   if (budget_enforcement)
+       budget.reset(new rt::cpu_budget);
+   Tracer::global().attach_thread();
+   arm_thread();
+   while (wait_release(T)) {
+        // frame del job preso in carico: a job in corso un nuovo rilascio (Skip) cambia T.job_tag
+        const unsigned int tag = T.job_tag;
+        run_job(tid, budget.get());
+
+        // prima torna idle (il job è finito a tutti gli effetti), poi lo conta per il frame
+        job_done(T);
+        job_completed(tag);
+        rt_check(T.trace_id);
    }
 }
 
-void Executive::exec_function() {
+void Executive::pool_function(size_t w) {
+    PoolWorker& W = pool[w];
+    std::unique_ptr<rt::cpu_budget> budget;
+    if (budget_enforcement)
+        budget.reset(new rt::cpu_budget);
+    Tracer::global().attach_thread();
+    arm_thread();
+    int seen = pool_epoch.load(std::memory_order_acquire);
+    while (!stopping.load(std::memory_order_acquire)) {
+        // prende il prossimo job della lista del frame corrente, nell'ordine del piano. La lista va letta
+        // con la tabella del suo modo: al cambio l'executive chiude la lista prima di pubblicare il modo e
+        // pubblica la nuova lista dopo, quindi se il modo non cambia tra le due letture sono coerenti
+        const unsigned long long mode = mode_word.load(std::memory_order_acquire);
+        unsigned long long cur = pool_cursor.load(std::memory_order_acquire);
+        if (mode_word.load(std::memory_order_acquire) != mode)
+            continue;
+        const ScheduleTable& S = mode_table(static_cast<size_t>(mode & 0xFFFF));
+        size_t frame_id = static_cast<size_t>(cur >> 32);
+        size_t i = static_cast<size_t>(cur & 0xFFFFFFFFull);
+        if (cur == POOL_CLOSED || i >= S.frame_begin[frame_id + 1] - S.frame_begin[frame_id]) {
+            rt::futex_wait(pool_epoch, seen);
+            seen = pool_epoch.load(std::memory_order_acquire);
+            continue;
+        }
+        if (!pool_cursor.compare_exchange_weak(cur, cur + 1, std::memory_order_acq_rel))
+            continue;
+
+        const size_t tid = S.jobs[S.frame_begin[frame_id] + i];
+        TaskData& T = tasks[tid];
+        // fallisce se il job è stato saltato o annullato a fine frame
+        int pending = static_cast<int>(State::Pending);
+        if (!T.state.compare_exchange_strong(pending, static_cast<int>(State::Running), std::memory_order_acq_rel))
+            continue;
+        const unsigned int tag = T.job_tag;
+        T.worker.store(static_cast<int>(w), std::memory_order_relaxed);
+
+        // priorità del job secondo il piano (la syscall solo se cambia o se l'executive l'ha abbassata)
+        const rt::priority p = plan_priority(i, pool_ap_running.load(std::memory_order_relaxed));
+        if (W.demoted.exchange(false, std::memory_order_acq_rel) || W.priority != p) {
+            rt::this_thread::set_priority(p);
+            W.priority = p;
+            Tracer::global().emit(TraceEvent::PriorityChange, T.trace_id, abs_frame.load(std::memory_order_relaxed),
+                                  p - rt::priority::not_rt);
+        }
+
+        // budget esaurito: il worker è già a priorità minima, la ripristina al prossimo job
+        if (run_job(tid, budget.get()))
+            W.priority = rt::priority::rt_min + 1;
+
+        T.worker.store(-1, std::memory_order_relaxed);
+        job_done(T);
+        job_completed(tag);
+        rt_check(T.trace_id);
+    }
+}
+
+void Executive::demote_worker(TaskData& T) {
+    // il job in ritardo continua a priorità minima sul suo worker, che la ripristina al job successivo
+    int w = T.worker.load(std::memory_order_relaxed);
+    if (w < 0)
+        return;
+    rt::set_priority(pool[w].thread, rt::priority::rt_min + 1);
+    ++exec_syscalls;
+    pool[w].demoted.store(true, std::memory_order_release);
+}
+
+uint64_t Executive::run_frame_inline(size_t frame_id, unsigned int tag,
+                                     std::chrono::steady_clock::time_point frame_start,
+                                     std::chrono::steady_clock::time_point frame_end) {
+    // esecuzione non preemptive nel thread executive, nell'ordine del piano di priorità;
+    // restituisce il tempo di CPU dei job, da non attribuire all'executive
+    const ScheduleTable& S = active_table();
+    uint64_t jobs_cpu = 0;
+
+    // deadline miss: il job è già terminato (o non è partito), la politica vale solo per i rilasci successivi
+    auto miss = [this, tag](size_t tid) {
+        auto& C = task_control[tid];
+        Tracer::global().emit(TraceEvent::DeadlineMiss, tasks[tid].trace_id, tag);
+        C.deadline_misses.fetch_add(1, std::memory_order_relaxed);
+        if (task_config[tid].policy == OverrunPolicy::Skip)
+            C.skip_count += 1;
+        else if (task_config[tid].policy == OverrunPolicy::Fallback)
+            C.fallback_next = true;
+    };
+
+    for (uint32_t j = S.frame_begin[frame_id]; j < S.frame_begin[frame_id + 1]; ++j) {
+        const size_t tid = S.jobs[j];
+        auto& T = tasks[tid];
+        auto& M = task_measures[tid];
+        const TaskConfig& cfg = task_config[tid];
+        if (!decide_release(tid))
+            continue;
+
+        if (std::chrono::steady_clock::now() >= frame_end) {
+            // il frame è già finito (un job precedente ha sforato): il job non viene eseguito
+            task_control[tid].skipped.fetch_add(1, std::memory_order_relaxed);
+            miss(tid);
+            continue;
+        }
+
+        arm_job(tid, tag, frame_start, frame_end);
+        Tracer::global().emit(TraceEvent::Release, T.trace_id, tag, T.fallback);
+        auto start = std::chrono::steady_clock::now();
+
+        // non preemptive: nessuno può chiedere l'annullamento durante il job (il token resta falso)
+        current_cancel.flag = &T.cancel;
+        uint64_t cpu_start = thread_cpu_ns();
+        Tracer::global().emit(TraceEvent::JobStart, T.trace_id, tag);
+        if (T.fallback)
+            cfg.fallback();
+        else
+            cfg.function();
+        Tracer::global().emit(TraceEvent::JobEnd, T.trace_id, tag);
+        current_cancel = CancelToken();
+        uint64_t cpu_end = thread_cpu_ns();
+        auto end = std::chrono::steady_clock::now();
+
+        M.latency_hist.record(elapsed_ns(T.release_stamp, start));
+        M.jitter_hist.record(elapsed_ns(frame_start, start));
+        M.response_hist.record(elapsed_ns(frame_start, end));
+        M.exec_hist.record(cpu_end - cpu_start);
+        jobs_cpu += cpu_end - cpu_start;
+
+        if (end > frame_end)
+            miss(tid);
+    }
+    return jobs_cpu;
+}
+
+size_t Executive::ap_frame_counters(size_t& rejected_seen, size_t& not_admitted_seen) {
+    // contatori delle richieste aperiodiche all'inizio del frame; restituisce le richieste in attesa
+    size_t pending_requests = ap_queue.size() + ap_backlog_size.load(std::memory_order_acquire);
+    size_t rejected_total = ap_rejected_total.load(std::memory_order_relaxed);
+    size_t not_admitted_total = ap_not_admitted_total.load(std::memory_order_relaxed);
+    ap_last_rejected.store(rejected_total - rejected_seen, std::memory_order_relaxed);
+    ap_last_not_admitted.store(not_admitted_total - not_admitted_seen, std::memory_order_relaxed);
+    ap_last_depth.store(pending_requests, std::memory_order_relaxed);
+    rejected_seen = rejected_total;
+    not_admitted_seen = not_admitted_total;
+    return pending_requests;
+}
+
+void Executive::arm_job(size_t tid, unsigned int tag, std::chrono::steady_clock::time_point release_time,
+                        std::chrono::steady_clock::time_point deadline_time) {
+    // prepara il job del task al rilascio (solo thread executive), prima di renderlo Pending
+    auto& T = tasks[tid];
+    auto& C = task_control[tid];
+    T.release_time = release_time;
+    T.deadline_time = deadline_time;
+    T.job_tag = tag;
+    T.over_budget.store(false, std::memory_order_relaxed);
+    T.cancel.store(false, std::memory_order_relaxed);
+    T.fallback = C.fallback_next;
+    if (C.fallback_next) {
+        C.fallback_next = false;
+        C.fallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+    T.release_stamp = clock->now();
+}
+
+void Executive::check_deadline(size_t tid) {
+    // verifica, alla sua deadline, il job rilasciato del task (solo thread executive)
+    auto& T = tasks[tid];
+    auto& C = task_control[tid];
+    const unsigned int tag = T.job_tag;
+
+    // budget esaurito: il worker si è già abbassato da solo, si aggiorna la priorità in cache
+    if (T.over_budget.load(std::memory_order_acquire) && exec_mode == ExecMode::Threads)
+        C.priority = rt::priority::rt_min + 1;
+
+    int s = T.state.load(std::memory_order_acquire);
+    if (s == static_cast<int>(State::Idle))
+        return;
+
+    Tracer::global().emit(TraceEvent::DeadlineMiss, T.trace_id, tag);
+    C.deadline_misses.fetch_add(1, std::memory_order_relaxed);
+    if (exec_mode == ExecMode::Pool)
+        demote_worker(T);
+    else
+        set_priority(C, T.trace_id, rt::priority::rt_min+1);
+
+    // se non è ancora partito annulla il rilascio (fallisce se il worker lo ha appena preso)
+    if (s == static_cast<int>(State::Pending)
+        && T.state.compare_exchange_strong(s, static_cast<int>(State::Idle), std::memory_order_acq_rel))
+        s = static_cast<int>(State::Idle);
+
+    // il job in ritardo prosegue a priorità minima; il seguito dipende dalla politica del task
+    const OverrunPolicy policy = task_config[tid].policy;
+    if (policy == OverrunPolicy::Skip) {
+        C.skip_count += 1;
+    } else if (policy != OverrunPolicy::Continue) {
+        if (s != static_cast<int>(State::Idle)) {
+            T.cancel.store(true, std::memory_order_release);
+            C.cancelled.fetch_add(1, std::memory_order_relaxed);
+            Tracer::global().emit(TraceEvent::JobCancel, T.trace_id, tag);
+        }
+        if (policy == OverrunPolicy::Fallback)
+            C.fallback_next = true;
+    }
+}
+
+void Executive::exec_function(std::chrono::steady_clock::time_point start_time) {
     size_t frame_id = 0;
-    auto next_time = std::chrono::steady_clock::now();
-    bool ap_request = false;
+    auto next_time = start_time;
     bool ap_running = false;
     State ap_state;
+    size_t rejected_seen = 0;
+    size_t not_admitted_seen = 0;
+    unsigned long long frame_count = 0;
+    unsigned long long hyperperiods_done = 0;
+    hyperperiod_origin = next_time;
+    const ScheduleTable* S = &active_table();
 
-    while (true) {
-#ifdef VERBOSE
-        std::cout << "\e[0;34m" <<"*** Frame " << frame_id << " start ***" << "\033[0m" << std::endl;
-#endif
+    // inizio di un iperperiodo: applica il cambio di modo richiesto, con un solo store atomico
+    // (le tabelle sono già in memoria; il nuovo modo parte dal frame first_frame)
+    auto switch_mode = [&](unsigned long long first_frame) {
+        size_t m = pending_mode.exchange(NO_MODE, std::memory_order_acq_rel);
+        if (m == NO_MODE || m == current_mode())
+            return;
+        // pool: la lista del frame precedente va chiusa prima di pubblicare la nuova tabella
+        if (exec_mode == ExecMode::Pool)
+            pool_cursor.store(POOL_CLOSED, std::memory_order_release);
+        mode_word.store((first_frame << 16) | m, std::memory_order_release);
+        S = &mode_table(m);
+        Tracer::global().emit(TraceEvent::ModeChange, TRACE_NO_TASK, static_cast<uint32_t>(first_frame),
+                              static_cast<int32_t>(m));
+    };
+    switch_mode(0);
 
-        // controllo task ancora in Running da frame precedente
-        for (size_t tid = 0; tid < tasks.size(); ++tid) {
-            auto& T = tasks[tid];
-            bool was_running;
-            {
-                std::lock_guard<std::mutex> lg(T.state_mtx);
-                was_running = (T.state == State::Running);
-            }
-            if (was_running) {
-#ifdef VERBOSE
-         std::cout << "\e[0;32m"<<"[Exec] Task " << tid << " riprende da frame precedente" << "\033[0m" << std::endl;
-#endif
+    // backend Deadline: attende le prenotazioni dei thread fatte da start()
+    exec_tid.store(rt::this_thread::get_tid(), std::memory_order_release);
+    if (deadline_requested())
+        while (sched_setup.load(std::memory_order_acquire) == 0)
+            rt::futex_wait(sched_setup, 0);
+
+    // timer dei frame: un confine ogni frame_length quanti a partire da start_time
+    clock->arm(start_time, frame_length * unit_time);
+    Tracer::global().attach_thread();
+    arm_thread();
+
+    // attende l'inizio (eventualmente condiviso con altri executive) del primo iperperiodo
+    unsigned long long missed = clock->wait_next();
+
+    if (sched_policy != SchedPolicy::Cyclic) {
+        priority_loop(start_time, missed);
+        dismiss_workers();
+        return;
+    }
+
+    while (true) {
+        // confini persi (risveglio in ritardo di oltre un frame): i frame corrispondenti vengono
+        // saltati, restando allineati alla griglia temporale invece di accumulare deriva
+        if (missed > 0) {
+            timer_overruns.fetch_add(missed, std::memory_order_relaxed);
+            Tracer::global().emit(TraceEvent::TimerOverrun, TRACE_NO_TASK, static_cast<uint32_t>(frame_count),
+                                  static_cast<int32_t>(missed));
+            bool limit_reached = false;
+            for (; missed > 0; --missed) {
+                next_time += frame_length * unit_time;
+                ++frame_count;
+                frame_id = (frame_id + 1) % S->num_frames;
+                if (frame_id != 0)
+                    continue;
+                if (hyperperiod_limit != 0 && ++hyperperiods_done == hyperperiod_limit) {
+                    limit_reached = true;
+                    break;
+                }
+                switch_mode(frame_count);
             }
+            if (limit_reached)
+                break;
         }
-    
+
+        uint64_t cpu_frame_start = thread_cpu_ns();
+        uint64_t inline_cpu = 0;
+        exec_syscalls = 0;
+
         auto frame_start = next_time;
         next_time = frame_start + frame_length * unit_time;
+        const unsigned int tag = static_cast<unsigned int>(frame_count);
+        abs_frame.store(frame_count++, std::memory_order_release);
+        Tracer::global().emit(TraceEvent::FrameStart, static_cast<uint16_t>(frame_id), tag);
 
-        // Gestione richieste aperiodiche
-        {
-            std::lock_guard<std::mutex> lg_request(ap_request_mtx);
-            ap_request = ap_request_pending;
-            ap_request_pending = false;  // Reset della richiesta
-        }
-
-        if (ap_request) {
-            // Quando ricevo una richiesta aperiodica, controllo se c'è un task aperiodico in esecuzione o pending
-            std::lock_guard<std::mutex> lg_ap(ap_T.state_mtx);
-            ap_state = ap_T.state;
-            
-            if (ap_state == State::Running || ap_state == State::Pending) {
-                std::cerr << "[AP] Deadline miss: richiesta ignorata perché il task aperiodico è ancora in esecuzione\n";
-            } else {
-                ap_T.state = State::Pending;
-            }
-            ap_running = true;
-            ap_request = false;
-        }
+        // Gestione richieste aperiodiche: contatori del frame (la coda la svuota il server)
+        size_t pending_requests = ap_frame_counters(rejected_seen, not_admitted_seen);
 
-        // Gestione task aperiodico
-        {
-            std::lock_guard<std::mutex> lg_ap(ap_T.state_mtx);
-            ap_state = ap_T.state;
+        // Gestione server aperiodico: se è libero e ci sono richieste lo rilascia
+        ap_state = get_state(ap_T);
+        if (ap_state == State::Idle && pending_requests > 0 && !ap_classes.empty()) {
+            release(ap_T);
+            ++exec_syscalls;
+            ap_state = State::Pending;
         }
         if (ap_state != State::Idle) {
             ap_running = true;
-            if (slack_times[frame_id] > 0) {
+            if (S->slack[frame_id] > 0) {
                 // Se c'è slack time, priorità massima-1 (inferiore all'executive)
-                rt::set_priority(ap_T.thread, rt::priority::rt_max - 1);
-#ifdef VERBOSE
-                std::cout << "[AP] Attivo aperiodico con priorità alta (slack disponibile)\n";
-#endif
+                set_priority(ap_control, ap_T.trace_id, rt::priority::rt_max - 1);
             } else {
                 // Se non c'è slack time, priorità minima ma comunque schedulato
-                rt::set_priority(ap_T.thread, rt::priority::rt_min);
-#ifdef VERBOSE
-                std::cout << "[AP] Attivo aperiodico con priorità minima (senza slack)\n";
-#endif
+                set_priority(ap_control, ap_T.trace_id, rt::priority::rt_min);
             }
-            ap_T.cv.notify_one();
         }
         else if (ap_state == State::Idle) {
-#ifdef VERBOSE
-                std::cout << "[AP] finito, torno false\n";
-#endif
             ap_running = false;
         }
 
 
 
-        // Attiva i task del frame con priorità decrescente
-        rt::priority maxp = rt::priority::rt_max;;
-        rt::priority prio_val;
-        for (size_t i = 0; i < frames[frame_id].size(); ++i) {
-            size_t tid = frames[frame_id][i];
-            auto& T = tasks[tid];
-            {
-                std::lock_guard<std::mutex> lg(T.state_mtx);
-                if (T.skip_count > 0) {
-                    --T.skip_count;
+        if (exec_mode == ExecMode::Inline) {
+            // i job del frame vengono eseguiti qui, in sequenza; l'aperiodico usa lo slack che resta
+            frame_jobs.store(static_cast<unsigned long long>(tag) << 32, std::memory_order_release);
+            inline_cpu = run_frame_inline(frame_id, tag, frame_start, next_time);
+        } else {
+            // Job periodici effettivamente rilasciati nel frame (esclusi quelli saltati)
+            unsigned long long released = 0;
+            const uint32_t first_job = S->frame_begin[frame_id];
+            const uint32_t end_job = S->frame_begin[frame_id + 1];
+            for (uint32_t j = first_job; j < end_job; ++j) {
+                auto& C = task_control[S->jobs[j]];
+                C.release_now = decide_release(S->jobs[j]);
+                released += C.release_now;
+            }
+            int complete_seen = frame_complete.load(std::memory_order_acquire);
+            frame_jobs.store((static_cast<unsigned long long>(tag) << 32) | released, std::memory_order_release);
+
+            // pool: chiude la lista del frame precedente prima di rendere Pending i nuovi job
+            if (exec_mode == ExecMode::Pool)
+                pool_cursor.store(POOL_CLOSED, std::memory_order_release);
+
+            // Attiva i task del frame con priorità decrescente, calcolata dalla posizione nel frame (plan_priority)
+            for (uint32_t j = first_job; j < end_job; ++j) {
+                const size_t tid = S->jobs[j];
+                auto& T = tasks[tid];
+                auto& C = task_control[tid];
+                if (!C.release_now)
                     continue;
+
+                // pool: la priorità la imposta il worker che prende il job
+                if (exec_mode != ExecMode::Pool) {
+                    set_priority(C, T.trace_id, plan_priority(j - first_job, ap_running));
                 }
+
+                // set release e deadline, poi rilascio
+                arm_job(tid, tag, frame_start, frame_start + frame_length * unit_time);
+                if (exec_mode == ExecMode::Pool) {
+                    T.state.store(static_cast<int>(State::Pending), std::memory_order_release);
+                } else {
+                    release(T);
+                    ++exec_syscalls;
+                }
+                Tracer::global().emit(TraceEvent::Release, T.trace_id, tag, T.fallback);
             }
-            
-            if (ap_running){
-                prio_val = maxp - static_cast<int>(i + 2);
-                #ifdef VERBOSE
-                std::cout << "[AP] ATTIVO, quindi priorità task: "<< tid <<" decreased: " <<prio_val <<"\n";
-                #endif
+
+            // pool: pubblica la lista del frame e sveglia tutti i worker con un solo wake
+            if (exec_mode == ExecMode::Pool) {
+                pool_ap_running.store(ap_running, std::memory_order_relaxed);
+                pool_cursor.store(static_cast<unsigned long long>(frame_id) << 32, std::memory_order_release);
+                pool_epoch.fetch_add(1, std::memory_order_release);
+                rt::futex_wake(pool_epoch, std::numeric_limits<int>::max());
+                ++exec_syscalls;
             }
-            else {
-                prio_val = maxp - static_cast<int>(i + 1);
-                #ifdef VERBOSE
-                std::cout << "[AP] INATTIVO, quindi priorità task: "<< tid <<" normal: "<<prio_val <<"\n";
-                #endif
+
+            // (un server SCHED_DEADLINE è già limitato dal suo budget: nessun cambio di priorità)
+            if (ap_running && S->slack[frame_id] > 0 && !ap_control.deadline) {
+                auto slack = frame_start + S->slack[frame_id] * unit_time;
+                clock->sleep_until(slack);
+                ++exec_syscalls;
+                set_priority(ap_control, ap_T.trace_id, rt::priority::rt_min);
+                ap_running = false;
             }
-            // calcolo prio_val = maxp - (i+1), clamped a [min+1, maxp]
-            //rt::priority prio_val = maxp - static_cast<int>(i + 1);
-            rt::priority minp = rt::priority::rt_min + 1;
-            if (prio_val < minp) prio_val = minp;
-            rt::set_priority(T.thread, prio_val);
-
-            // set release e deadline
-            {
-            std::lock_guard<std::mutex> lg(T.state_mtx);
-            T.release_time = frame_start;
-            T.deadline_time = frame_start + frame_length * unit_time;
-            T.state = State::Pending;
+
+            // attende la fine dei job periodici del frame (o il prossimo frame)
+            while ((frame_jobs.load(std::memory_order_acquire) & 0xFFFFFFFFull) != 0
+                   && (++exec_syscalls, clock->wait_until(frame_complete, complete_seen, next_time)))
+                complete_seen = frame_complete.load(std::memory_order_acquire);
+        }
+
+        // recupero dello slack: il budget non usato dai job periodici passa al server aperiodico
+        auto done_time = clock->now();
+        long long reclaimed = 0;
+        if (done_time < next_time) {
+            reclaimed = std::chrono::duration_cast<std::chrono::nanoseconds>(next_time - done_time).count();
+            if (!ap_classes.empty() && (get_state(ap_T) != State::Idle
+                                        || ap_queue.size() + ap_backlog_size.load(std::memory_order_acquire) > 0)) {
+                if (get_state(ap_T) == State::Idle) {
+                    release(ap_T);
+                    ++exec_syscalls;
+                }
+                set_priority(ap_control, ap_T.trace_id, rt::priority::rt_max - 1);
             }
-            
-            T.cv.notify_one();
+            Tracer::global().emit(TraceEvent::SlackReclaim, TRACE_NO_TASK, tag, static_cast<int32_t>(reclaimed / 1000));
         }
+        reclaimed_last.store(reclaimed, std::memory_order_relaxed);
+        reclaimed_total.fetch_add(reclaimed, std::memory_order_relaxed);
 
-        if (ap_running && slack_times[frame_id] > 0){
-
-            auto slack = frame_start + slack_times[frame_id] * unit_time;
-#ifdef VERBOSE
-            std::cout << "[AP] Dormo\n";
-#endif
-            std::this_thread::sleep_until(slack);
-        rt::set_priority(ap_T.thread, rt::priority::rt_min);
-        ap_running = false;
-#ifdef VERBOSE
-        std::cout << "[AP] Task aperiodico in attesa fino allo slack time, torno a dormire\n";
-#endif
+        // dormi fino al prossimo frame, misurando il ritardo del risveglio
+        uint64_t cpu_before_sleep = thread_cpu_ns();
+        missed = clock->wait_next();
+        ++exec_syscalls;
+        auto boundary = next_time + missed * frame_length * unit_time;
+        wakeup_hist.record(elapsed_ns(boundary, clock->now()));
+        uint64_t cpu_after_sleep = thread_cpu_ns();
+
+        // verifica deadline miss, solo sui job rilasciati in questo frame (i saltati hanno un tag vecchio)
+        for (uint32_t j = S->frame_begin[frame_id]; j < S->frame_begin[frame_id + 1]; ++j) {
+            const size_t tid = S->jobs[j];
+            if (tasks[tid].job_tag == tag)
+                check_deadline(tid);
         }
 
-        // dormi fino al prossimo frame
-        std::this_thread::sleep_until(next_time);
+        // costo dell'executive nel frame: tempo di CPU (esclusi i job inline e le misure attorno al sonno) e syscall
+        exec_cpu_hist.record((cpu_before_sleep - cpu_frame_start) + (thread_cpu_ns() - cpu_after_sleep) - inline_cpu);
+        syscall_hist.record(exec_syscalls);
+        rt_check(TRACE_NO_TASK);
+        frames_run.fetch_add(1, std::memory_order_relaxed);
 
-        // verifica deadline miss
-        int tid = 0;
-        for (auto& T : tasks) {
-            bool idle;
-            std::lock_guard<std::mutex> lg(T.state_mtx);
-            idle = (T.state == State::Idle);
+        if (stop_requested.load(std::memory_order_acquire))
+            break;
+        frame_id = (frame_id + 1) % S->num_frames;
+        if (frame_id == 0) {
+            if (hyperperiod_limit != 0 && ++hyperperiods_done == hyperperiod_limit)
+                break;
+            switch_mode(frame_count);
+        }
+    }
+
+    // fine dell'esecuzione: nessun job viene più rilasciato, i worker terminano (vedi wait())
+    dismiss_workers();
+}
+
+void Executive::priority_loop(std::chrono::steady_clock::time_point start_time, unsigned long long missed) {
+    // politiche a priorità: un tick ogni frame_length quanti; a ogni tick rilascia i task il cui periodo
+    // è trascorso e assegna le priorità (RM: fisse, EDF: per deadline assoluta dei job attivi); al
+    // confine successivo verifica i job la cui deadline è scaduta. Il server aperiodico resta in
+    // background, a priorità minima: serve le richieste quando nessun job periodico è pronto
+    typedef std::pair<unsigned long long, uint32_t> Release;
+    auto later = [](const Release& a, const Release& b) { return a > b; };
+    const std::chrono::nanoseconds tick_length = frame_length * unit_time;
+    size_t rejected_seen = 0;
+    size_t not_admitted_seen = 0;
+    unsigned long long tick = 0;
+    auto tick_start = start_time;
+
+    // verifica dei job con deadline entro "boundary", che escono dall'insieme dei job attivi
+    auto expire = [this](std::chrono::steady_clock::time_point boundary) {
+        for (size_t i = 0; i < prio_active.size();) {
+            const size_t tid = prio_active[i];
+            if (tasks[tid].deadline_time > boundary) {
+                ++i;
+                continue;
+            }
+            check_deadline(tid);
+            prio_active[i] = prio_active.back();
+            prio_active.pop_back();
+        }
+    };
+
+    while (true) {
+        // tick persi: i rilasci che vi cadevano vengono saltati (le deadline sono già state verificate)
+        if (missed > 0) {
+            timer_overruns.fetch_add(missed, std::memory_order_relaxed);
+            Tracer::global().emit(TraceEvent::TimerOverrun, TRACE_NO_TASK, static_cast<uint32_t>(tick),
+                                  static_cast<int32_t>(missed));
+            tick += missed;
+            tick_start += missed * tick_length;
+            missed = 0;
+            if (hyperperiod_limit != 0 && tick >= hyperperiod_limit * hyperperiod_ticks)
+                break;
+        }
 
-            if (!idle) {
-                std::cerr << "\e[0;31m" << "Deadline miss" << "\033[0m" << ": task " << tid << std::endl;
-                rt::set_priority(T.thread, rt::priority::rt_min+1);
+        uint64_t cpu_frame_start = thread_cpu_ns();
+        exec_syscalls = 0;
+        const unsigned int tag = static_cast<unsigned int>(tick);
+        abs_frame.store(tick, std::memory_order_release);
+        Tracer::global().emit(TraceEvent::FrameStart, static_cast<uint16_t>(tick % hyperperiod_ticks), tag);
 
-                bool running;
-                running = (T.state == State::Running);
+        // richieste aperiodiche: il server in background viene rilasciato se è libero e ce ne sono
+        size_t pending_requests = ap_frame_counters(rejected_seen, not_admitted_seen);
+        if (get_state(ap_T) == State::Idle && pending_requests > 0 && !ap_classes.empty()) {
+            release(ap_T);
+            ++exec_syscalls;
+        }
 
-                if (!running) {
-                    T.state = State::Idle;
-                } 
+        // job del tick: prepara quelli da rilasciare, ma li rende Pending solo dopo averne fissato la priorità
+        prio_released.clear();
+        while (!release_heap.empty() && release_heap.front().first <= tick) {
+            std::pop_heap(release_heap.begin(), release_heap.end(), later);
+            Release& next = release_heap.back();
+            const size_t tid = next.second;
+            const bool on_time = next.first == tick;
+            next.first += task_config[tid].period / frame_length;
+            std::push_heap(release_heap.begin(), release_heap.end(), later);
 
-                T.skip_count += 1;
-                
+            if (!on_time) {
+                task_control[tid].skipped.fetch_add(1, std::memory_order_relaxed);
+                continue;
             }
-            ++tid;
+            if (!decide_release(tid))
+                continue;
+            arm_job(tid, tag, tick_start, tick_start + task_config[tid].deadline * unit_time);
+            prio_released.push_back(static_cast<uint32_t>(tid));
         }
 
+        if (sched_policy == SchedPolicy::Edf) {
+            // EDF: livelli di priorità in ordine di deadline assoluta tra i job ancora da completare
+            // (l'ordine cambia solo ai rilasci: le priorità già giuste non costano syscall)
+            prio_rank.clear();
+            for (uint32_t tid : prio_active)
+                if (get_state(tasks[tid]) != State::Idle)
+                    prio_rank.push_back(tid);
+            prio_rank.insert(prio_rank.end(), prio_released.begin(), prio_released.end());
+            std::sort(prio_rank.begin(), prio_rank.end(), [this](uint32_t a, uint32_t b) {
+                if (tasks[a].deadline_time != tasks[b].deadline_time)
+                    return tasks[a].deadline_time < tasks[b].deadline_time;
+                return a < b;
+            });
+            for (size_t r = 0; r < prio_rank.size(); ++r)
+                set_priority(task_control[prio_rank[r]], tasks[prio_rank[r]].trace_id, plan_priority(r, false));
+        } else {
+            for (uint32_t tid : prio_released)
+                set_priority(task_control[tid], tasks[tid].trace_id, rm_priority[tid]);
+        }
+
+        for (uint32_t tid : prio_released) {
+            auto& T = tasks[tid];
+            release(T);
+            ++exec_syscalls;
+            Tracer::global().emit(TraceEvent::Release, T.trace_id, tag, T.fallback);
+            prio_active.push_back(tid);
+        }
+
+        // dormi fino al prossimo tick, misurando il ritardo del risveglio
+        uint64_t cpu_before_sleep = thread_cpu_ns();
+        missed = clock->wait_next();
+        ++exec_syscalls;
+        tick_start += tick_length;
+        auto boundary = tick_start + missed * tick_length;
+        wakeup_hist.record(elapsed_ns(boundary, clock->now()));
+        uint64_t cpu_after_sleep = thread_cpu_ns();
+
+        expire(boundary);
+
+        exec_cpu_hist.record((cpu_before_sleep - cpu_frame_start) + (thread_cpu_ns() - cpu_after_sleep));
+        syscall_hist.record(exec_syscalls);
+        rt_check(TRACE_NO_TASK);
+        frames_run.fetch_add(1, std::memory_order_relaxed);
 
-#ifdef VERBOSE
-        std::cout << "\e[0;34m" << "*** Frame " << frame_id << " end ***" << "\033[0m" << std::endl;
-#endif
-        frame_id = (frame_id + 1) % frames.size();
+        ++tick;
+        if (stop_requested.load(std::memory_order_acquire))
+            break;
+        if (hyperperiod_limit != 0 && tick >= hyperperiod_limit * hyperperiod_ticks)
+            break;
     }
 }
\ No newline at end of file
@@ -2,17 +2,139 @@
 #define EXECUTIVE_H
 
 #include <vector>
-#include <functional>
 #include <chrono>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
 #include <thread>
+#include <cstdint>
 
 #include "rt/priority.h"
+#include "rt/affinity.h"
+#include "rt/timer.h"
+#include "rt/memory.h"
+#include "rt/budget.h"
+#include "rt/deadline.h"
+#include "exec_clock.h"
+#include "mpsc_queue.h"
+#include "inline_function.h"
+#include "schedule.h"
+#include "histogram.h"
 
 class Executive {
+    friend class Simulator;
 public:
-    enum class State { Idle, Pending, Running };
+    enum class State { Idle, Pending, Running, Stopped };
+
+    // Funzioni dei task: memorizzate nell'oggetto, senza allocazioni (lambda con catture piccole,
+    // puntatori a funzione, o puntatore a funzione + contesto)
+    typedef InlineFunction<void(), 32> Task;
+    typedef InlineFunction<void(void*), 64> ApTask;
+
+    // Trattamento di un job che a fine frame non ha terminato (deadline miss); in ogni caso il job
+    // prosegue a priorità minima, perché non può essere interrotto:
+    // - Skip (default): il rilascio successivo del task viene saltato, e anche i seguenti finché il job non è terminato;
+    // - Continue: il job finisce nello slack; il rilascio successivo avviene solo se nel frattempo è terminato;
+    // - Abort: come Continue, e il job riceve la richiesta di annullamento (vedi cancel_token());
+    // - Fallback: come Abort, e al rilascio successivo viene eseguita la funzione di riserva (set_fallback_task)
+    // In modalità inline il job in ritardo è già terminato: Abort equivale a Continue; un job non eseguito
+    // perché il frame è già finito conta come deadline miss e come rilascio saltato
+    enum class OverrunPolicy { Skip, Continue, Abort, Fallback };
+
+    // Richiesta di annullamento cooperativo del job in esecuzione (vedi cancel_token()):
+    // true dopo la deadline del job, o all'esaurimento del budget (set_budget_enforcement)
+    class CancelToken {
+    public:
+        bool cancelled() const {
+            return (flag && flag->load(std::memory_order_relaxed)) || (budget && budget->load(std::memory_order_relaxed));
+        }
+    private:
+        friend class Executive;
+        const std::atomic<bool>* flag{nullptr};
+        const std::atomic<bool>* budget{nullptr};
+    };
+
+    // Ordine di servizio delle richieste aperiodiche (soft) accodate;
+    // i job sporadici accettati sono sempre serviti prima, in ordine di deadline
+    enum class ApOrder { FIFO, Deadline };
+
+    // Esecuzione dei job periodici: un thread per task (preemptive, default), direttamente nel
+    // thread executive, in sequenza (non preemptive, nessun cambio di contesto), oppure su un pool
+    // fisso di worker vincolati ai core, che prendono i job del frame nell'ordine del piano
+    enum class ExecMode { Threads, Inline, Pool };
+
+    // Fase di armamento eseguita da start() prima del primo frame, per non avere page fault né
+    // allocazioni nei job: blocco della memoria, stack dei thread e heap già mappati, contenitori fissati
+    struct ArmConfig {
+        rt::memory_lock memory_lock{rt::memory_lock::all};  // mlockall (touched: solo le pagine toccate)
+        size_t stack_prefault{128 * 1024};   // byte di stack toccati da ogni thread dell'executive (0 = nessuno)
+        size_t heap_reserve{0};              // byte di heap toccati e trattenuti dall'allocatore (0 = nessuno)
+        bool check{false};                   // debug: verifica (assert) che dopo l'armamento i thread
+                                             // dell'executive non allochino né subiscano page fault
+    };
+
+    // Politica di scheduling dei task periodici: clock-driven sulla tabella dei frame (Cyclic, default),
+    // oppure a priorità, con rilasci a ogni periodo del task (set_task_timing) scanditi da un tick di
+    // frame_length quanti: priorità fisse per periodo (RateMonotonic) o per deadline assoluta (Edf)
+    enum class SchedPolicy { Cyclic, RateMonotonic, Edf };
+
+    // Scheduling dei thread dell'executive: priorità fisse SCHED_FIFO riprogrammate a ogni frame
+    // secondo il piano (Fifo, default), oppure prenotazioni SCHED_DEADLINE del kernel (Deadline),
+    // che applica da sé i budget dei job e fa del server aperiodico un constant-bandwidth server
+    enum class SchedBackend { Fifo, Deadline };
+
+    // Parametri del backend Deadline (periodo dell'executive e del server: un frame)
+    struct DeadlineConfig {
+        std::chrono::nanoseconds exec_runtime{0};   // budget del thread executive per frame (0 = 5% del frame)
+        std::chrono::nanoseconds server_runtime{0}; // budget del server aperiodico per frame (0 = la banda
+                                                    // libera entro il 95%, ridotta finché il kernel la ammette)
+    };
+
+    // Contatori relativi all'ultimo frame avviato
+    struct ApCounters {
+        size_t queue_depth;   // richieste in attesa a inizio frame
+        size_t rejected;      // richieste rifiutate (coda piena) durante il frame precedente
+        size_t not_admitted;  // job sporadici respinti (test di accettazione o interarrivo) nel frame precedente
+        size_t served;        // richieste servite in totale
+        std::chrono::nanoseconds reclaimed;        // budget recuperato nel frame precedente (job periodici finiti prima del WCET)
+        std::chrono::nanoseconds reclaimed_total;  // budget recuperato in totale
+    };
+
+    // Riassunto di una grandezza temporale misurata (percentili da istogramma log-lineare, errore < 7%)
+    struct LatencyStats {
+        uint64_t count;
+        std::chrono::nanoseconds min, mean, max;
+        std::chrono::nanoseconds p50, p90, p99, p999, p9999;
+    };
+
+    struct TaskStats {
+        LatencyStats release_latency;  // inizio effettivo del job - istante del rilascio da parte dell'executive
+        LatencyStats release_jitter;   // inizio effettivo del job - inizio del frame
+        LatencyStats response_time;    // fine del job - inizio del frame
+        LatencyStats exec_time;        // tempo di CPU del job (CLOCK_THREAD_CPUTIME_ID)
+        uint64_t deadline_misses;
+        uint64_t budget_overruns;      // job che hanno esaurito il budget di CPU (WCET), vedi set_budget_enforcement
+        OverrunPolicy overrun_policy;
+        uint64_t skipped;              // rilasci saltati per un job in ritardo (Skip, o job non ancora terminato)
+        uint64_t cancelled;            // job in ritardo a cui è stato chiesto l'annullamento (Abort, Fallback)
+        uint64_t fallbacks;            // esecuzioni della funzione di riserva (Fallback)
+        bool sched_deadline;           // thread del task in SCHED_DEADLINE (backend Deadline)
+    };
+
+    struct Stats {
+        std::vector<TaskStats> tasks;      // indicizzate per task_id
+        LatencyStats ap_response_time;     // completamento - arrivo delle richieste aperiodiche
+        LatencyStats wakeup_lateness;      // ritardo del risveglio dell'executive a inizio frame
+        uint64_t timer_overruns;           // confini di frame persi dal timer (frame saltati)
+        LatencyStats exec_cpu_per_frame;   // tempo di CPU del thread executive per frame
+        double syscalls_per_frame;         // syscall dell'executive per frame (media)
+        uint64_t max_syscalls_per_frame;
+        uint64_t frames;                   // frame eseguiti
+        bool memory_locked;                // memoria bloccata dall'armamento (false se non abilitato o non permesso)
+        uint64_t rt_allocations;           // allocazioni nei thread dell'executive dopo l'armamento (ArmConfig::check)
+        uint64_t rt_page_faults;           // page fault (minor + major) nei thread dell'executive dopo l'armamento (ArmConfig::check)
+        bool sched_deadline;               // thread executive in SCHED_DEADLINE (backend Deadline attivo)
+        bool ap_sched_deadline;            // server aperiodico in SCHED_DEADLINE (constant-bandwidth server)
+        uint64_t deadline_fallbacks;       // thread rimasti in SCHED_FIFO con il backend Deadline richiesto (banda esaurita o prenotazione rifiutata)
+    };
 
     /* [INIT] Inizializza l'executive, impostando i parametri di scheduling:
 			num_tasks: numero totale di task presenti nello schedule;
@@ -21,62 +143,485 @@ public:
 	*/
 	Executive(size_t num_tasks, unsigned int frame_length, unsigned int unit_duration = 10);
 
+	/* [INIT] Come sopra, con quanti temporali sotto il millisecondo (es. 50us per loop a 20 kHz):
+			unit_duration: durata dell'unita di tempo (risoluzione al nanosecondo).
+	*/
+	Executive(size_t num_tasks, unsigned int frame_length, std::chrono::nanoseconds unit_duration);
+
+	/* Termina l'esecuzione (come stop() seguito da wait()) e attende tutti i thread */
+	~Executive();
+
 	/* [INIT] Imposta il task periodico di indice "task_id" (da invocare durante la creazione dello schedule):
 		task_id: indice progressivo del task, nel range [0, num_tasks);
 		periodic_task: funzione da eseguire al rilascio del task;
-		wcet: tempo di esecuzione di caso peggiore (in quanti temporali).
+		wcet: tempo di esecuzione di caso peggiore (in quanti temporali);
+		policy: trattamento dei job che non rispettano la deadline (vedi OverrunPolicy).
 	*/
-	void set_periodic_task(size_t task_id, std::function<void()> periodic_task, unsigned int wcet);
+	void set_periodic_task(size_t task_id, Task periodic_task, unsigned int wcet, OverrunPolicy policy = OverrunPolicy::Skip);
+
+	/* [INIT] Funzione di riserva (degradata) del task "task_id", con politica Fallback:
+		fallback: funzione eseguita al posto del task nel rilascio successivo a un deadline miss;
+		wcet: tempo di esecuzione di caso peggiore (in quanti temporali, di norma minore di quello del task).
+	*/
+	void set_fallback_task(size_t task_id, Task fallback, unsigned int wcet);
 	
 	/* [INIT] Imposta il task aperiodico (da invocare durante la creazione dello schedule):
 		aperiodic_task: funzione da eseguire al rilascio del task;
 		wcet: tempo di esecuzione di caso peggiore (in quanti temporali).
 	*/
-	void set_aperiodic_task(std::function<void()> aperiodic_task, unsigned int wcet);
+	void set_aperiodic_task(Task aperiodic_task, unsigned int wcet);
+
+	/* [INIT] Come sopra, ma la funzione riceve l'argomento passato alla singola richiesta:
+		aperiodic_task: funzione da eseguire per ogni richiesta servita;
+		wcet: tempo di esecuzione di caso peggiore (in quanti temporali).
+	*/
+	void set_aperiodic_task(ApTask aperiodic_task, unsigned int wcet);
+
+	/* [INIT] Registra una nuova classe di task aperiodici (soft), servita nello slack; restituisce l'id della classe:
+		aperiodic_task: funzione da eseguire per ogni richiesta servita;
+		wcet: tempo di esecuzione di caso peggiore (in quanti temporali);
+		rel_deadline: deadline relativa all'arrivo (in quanti temporali, 0 = nessuna).
+	*/
+	size_t add_aperiodic_task(ApTask aperiodic_task, unsigned int wcet, unsigned int rel_deadline = 0);
+
+	/* [INIT] Registra una classe di task sporadici; restituisce l'id della classe.
+		Un job viene accettato solo se lo slack dei frame successivi ne garantisce la deadline, dopo i
+		job sporadici già accettati e l'eventuale job soft in servizio (il server non è preemptive):
+		sporadic_task: funzione da eseguire per ogni job accettato;
+		wcet: tempo di esecuzione di caso peggiore (in quanti temporali);
+		rel_deadline: deadline relativa all'arrivo (in quanti temporali, > 0);
+		min_interarrival: tempo minimo tra due arrivi (in quanti temporali).
+	*/
+	size_t add_sporadic_task(ApTask sporadic_task, unsigned int wcet, unsigned int rel_deadline, unsigned int min_interarrival);
+
+	/* [INIT] Configura la coda delle richieste aperiodiche (default: 64 richieste, FIFO):
+		capacity: numero massimo di richieste in attesa (arrotondato a potenza di 2);
+		order: ordine di servizio (FIFO o per deadline assoluta).
+	*/
+	void set_aperiodic_queue(size_t capacity, ApOrder order = ApOrder::FIFO);
 	
 	/* [INIT] Lista di task da eseguire in un dato frame (da invocare durante la creazione dello schedule):
-		frame: lista degli id corrispondenti ai task da eseguire nel frame, in sequenza
+		frame: lista degli id corrispondenti ai task da eseguire nel frame, in sequenza (senza ripetizioni:
+		       un task ha al più un job per frame)
 	*/
 	void add_frame(std::vector<size_t> frame);
 
-	/* [RUN] Lancia l'applicazione */
+	/* [INIT] Usa uno schedule già pronto al posto di add_frame, es. StaticSchedule<...>::table()
+		(validato a tempo di compilazione; nessuna allocazione, le tabelle non vengono copiate):
+		table: tabella di schedule, che deve restare valida per tutta l'esecuzione;
+		la lunghezza del frame e i WCET dei task sono presi dalla tabella.
+	*/
+	void set_schedule(const ScheduleTable & table);
+
+	/* [INIT] Come set_periodic_task, con il WCET preso dallo schedule impostato con set_schedule */
+	void set_periodic_task(size_t task_id, Task periodic_task, OverrunPolicy policy = OverrunPolicy::Skip);
+
+	/* [INIT] Vincola executive, task periodici e server aperiodico ai core indicati
+		(di default non viene impostata alcuna affinità):
+		cpus: insieme dei core ammessi.
+	*/
+	void set_affinity(const rt::cpu_set & cpus);
+
+	/* [INIT] Sceglie come vengono eseguiti i job periodici (da invocare prima di set_periodic_task):
+		mode: Threads (un thread per task, default), Inline (il thread executive esegue in sequenza
+		      i job del frame; adatto a frame con job brevi che terminano sicuramente entro il frame)
+		      o Pool (pochi worker condivisi, utile con centinaia di task);
+		pool_workers: numero di worker in modalità Pool (0 = uno per core ammesso, vedi set_affinity).
+		In modalità Inline le deadline sono comunque verificate (un job non ancora iniziato a fine frame
+		non viene eseguito) e il server aperiodico usa lo slack che resta dopo i job del frame.
+		In modalità Pool un job in ritardo prosegue a priorità minima ma occupa il suo worker fino alla
+		fine: per non ritardare i job del frame successivo conviene un worker di scorta per core.
+	*/
+	void set_execution_mode(ExecMode mode, size_t pool_workers = 0);
+
+	/* [INIT] Abilita la fase di armamento in start() (da invocare prima di set_periodic_task;
+		di default non viene eseguita). Dopo l'armamento lo schedule, i task e le classi aperiodiche
+		non possono più essere modificati; con config.check ogni job (e ogni frame per il thread
+		executive) verifica di non aver allocato né causato page fault, riportandoli in stats():
+		config: blocco della memoria, byte di stack e di heap da pre-toccare, verifica di debug.
+		Il blocco della memoria richiede CAP_IPC_LOCK o un RLIMIT_MEMLOCK sufficiente (vedi stats().memory_locked).
+	*/
+	void set_arm(const ArmConfig & config);
+
+	/* [INIT] Abilita il controllo del budget di ogni job (da invocare prima di set_periodic_task):
+		ogni worker usa un timer sul proprio tempo di CPU (CLOCK_THREAD_CPUTIME_ID) pari al WCET del
+		task; quando il job lo esaurisce il worker viene subito abbassato a priorità minima, senza
+		attendere la fine del frame, e il superamento è contato in stats().tasks[].budget_overruns.
+		Il job prosegue (a priorità minima); a fine frame viene verificata la deadline come sempre.
+		I task con WCET 0 e la modalità Inline non hanno budget; in modalità Pool il job abbassato
+		occupa comunque il suo worker (servono worker di scorta). Il segnale usato è SIGRTMIN.
+		enabled: true per abilitare il controllo.
+	*/
+	void set_budget_enforcement(bool enabled);
+
+	/* [INIT] Sceglie la politica di scheduling dei task periodici (da invocare prima di start()):
+		policy: Cyclic (default: tabella dei frame di add_frame/set_schedule/add_mode), RateMonotonic
+		        o Edf. Con RateMonotonic ed Edf frame_length è il tick dei rilasci: a ogni tick l'executive
+		        verifica le deadline scadute, rilascia i job dei task il cui periodo (set_task_timing) è
+		        trascorso e assegna le priorità: fisse in ordine di periodo (RM) o, a ogni tick, in ordine
+		        di deadline assoluta dei job attivi (EDF). Oltre i livelli SCHED_FIFO disponibili le
+		        priorità più basse coincidono. Il server aperiodico è in background (priorità minima) e
+		        le classi sporadiche non sono ammesse (non c'è slack precalcolato); richiede la modalità
+		        Threads e nessun modo aggiuntivo. Statistiche, politiche di overrun, budget e trace sono
+		        le stesse della politica Cyclic (FrameStart segna ogni tick).
+		Vedi task_set.h per registrare un task set una sola volta ed eseguirlo con ciascuna politica.
+	*/
+	void set_policy(SchedPolicy policy);
+
+	/* [INIT] Periodo e deadline del task "task_id", per le politiche RateMonotonic ed Edf
+		(multipli di frame_length; il primo rilascio avviene all'avvio):
+		period: periodo (in quanti temporali);
+		deadline: deadline relativa al rilascio (in quanti temporali, 0 = pari al periodo), al più il periodo.
+	*/
+	void set_task_timing(size_t task_id, unsigned int period, unsigned int deadline = 0);
+
+	/* [INIT] Sceglie come il kernel schedula i thread dell'executive (da invocare prima di start()):
+		backend: Fifo (default) o Deadline. Con Deadline, in start() il thread executive (runtime
+		         config.exec_runtime), il server aperiodico (config.server_runtime, con recupero della
+		         banda inutilizzata) e i task (runtime pari al WCET) passano a SCHED_DEADLINE, con
+		         deadline relativa di un frame e periodo pari alla distanza minima tra due rilasci del
+		         task nelle tabelle dei modi. L'executive non riprogramma più le priorità: i job del frame
+		         sono ordinati per deadline (rilasciati in ordine di piano), un job che esaurisce il
+		         budget viene sospeso dal kernel fino al periodo successivo.
+		Se il kernel rifiuta la prenotazione dell'executive (permessi, kernel senza SCHED_DEADLINE),
+		o con set_affinity, modalità Inline o Pool, o in simulazione, si resta sul backend Fifo.
+		I task passano a SCHED_DEADLINE tutti insieme o nessuno, perché un thread SCHED_DEADLINE
+		precede sempre quelli SCHED_FIFO: se un task ha WCET 0 o la sua prenotazione è rifiutata
+		(banda esaurita) anche l'executive resta su Fifo. Un server rifiutato resta in SCHED_FIFO
+		(vedi stats().sched_deadline, ap_sched_deadline e deadline_fallbacks).
+		config: budget per frame dell'executive e del server aperiodico (default: DeadlineConfig()).
+	*/
+	void set_sched_backend(SchedBackend backend);
+	void set_sched_backend(SchedBackend backend, const DeadlineConfig & config);
+
+	/* [INIT] Sceglie il timer che scandisce i frame (default: clock_nanosleep assoluto, senza spin):
+		backend: sleep (std::this_thread::sleep_until), nanosleep (clock_nanosleep assoluto su CLOCK_MONOTONIC)
+		         o timerfd periodico (le scadenze perse sono contate dal kernel);
+		spin_tail: ultimo tratto di attesa eseguito in busy-wait, per ridurre il ritardo del risveglio.
+		Il ritardo ottenuto è riportato in stats().wakeup_lateness; i confini persi in stats().timer_overruns.
+	*/
+	void set_frame_timer(rt::timer_backend backend, std::chrono::nanoseconds spin_tail = std::chrono::nanoseconds(0));
+
+	/* [INIT] Registra un modo operativo alternativo e ne restituisce l'id (il modo 0, iniziale, è lo
+		schedule di add_frame/set_schedule). Tutti i modi condividono i task registrati con
+		set_periodic_task: ogni modo ne esegue il sottoinsieme presente nella sua tabella.
+		table: tabella di schedule (es. StaticSchedule<...>::table() o SynthesizedSchedule::table()),
+		       che deve restare valida per tutta l'esecuzione, con la stessa lunghezza di frame
+		       e lo stesso numero di task dello schedule iniziale.
+	*/
+	size_t add_mode(const ScheduleTable & table);
+
+	/* [INIT] Limita l'esecuzione a un numero fissato di iperperiodi (0 = infinito, default),
+		dopo i quali il thread executive termina e wait() ritorna (es. per i benchmark):
+		hyperperiods: numero di iperperiodi da eseguire.
+	*/
+	void set_hyperperiod_limit(unsigned long long hyperperiods);
+
+	/* [INIT] Sostituisce la sorgente del tempo e delle attese dell'executive (es. il simulatore,
+		vedi simulator.h; da invocare prima di set_periodic_task). Con un orologio diverso da quello
+		reale i task non hanno thread e la modalità di esecuzione deve essere Threads:
+		clock: nuova sorgente del tempo, che deve restare valida per tutta l'esecuzione.
+	*/
+	void set_clock(ExecClock & clock);
+
+	/* [RUN] Esegue la fase di armamento abilitata con set_arm (riserva dello heap e blocco della
+		memoria), che altrimenti esegue start(); con start(start_time) va invocata prima di scegliere
+		start_time, perché il blocco della memoria può durare più frame (che risulterebbero persi).
+		Dopo l'armamento lo schedule e i task non vanno più modificati.
+	*/
+	void arm();
+
+	/* [RUN] Lancia l'applicazione (dopo l'armamento, se abilitato) */
 	void start();
 
-	/* [RUN] Attende (all'infinito) finchè gira l'applicazione */
+	/* [RUN] Lancia l'applicazione facendo iniziare il primo iperperiodo all'istante indicato
+		(usato per sincronizzare più executive, es. uno per core; vedi arm()):
+		start_time: istante di inizio del primo frame.
+	*/
+	void start(std::chrono::steady_clock::time_point start_time);
+
+	/* [RUN] Attende (all'infinito, o fino a stop() o al limite di iperperiodi) finchè gira l'applicazione;
+		al ritorno il thread executive, i thread dei task e il server aperiodico sono terminati.
+	*/
 	void wait();
 
-	/* [RUN] Richiede il rilascio del task aperiodico (da invocare durante l'esecuzione).
+	/* [RUN] Termina l'esecuzione alla fine del frame corrente (senza lock, da qualsiasi thread):
+		i job del frame vengono verificati come sempre, non vengono rilasciati altri job e i worker
+		terminano dopo il job in corso; le richieste aperiodiche ancora in coda non vengono servite.
 	*/
-	void ap_task_request();
+	void stop();
+
+	/* [RUN] Richiede il passaggio al modo "mode" (vedi add_mode) al prossimo confine di iperperiodo
+		(senza lock né allocazioni; l'executive non si ferma). Una nuova richiesta prima del confine
+		sostituisce la precedente.
+	*/
+	void change_mode(size_t mode);
+
+	/* [RUN] Modo in esecuzione */
+	size_t current_mode() const;
+
+	/* [RUN] Richiede il rilascio del task aperiodico (da invocare durante l'esecuzione, senza lock):
+		arg: argomento passato al task per questa richiesta;
+		rel_deadline: deadline relativa all'arrivo (in quanti temporali, 0 = nessuna).
+		Restituisce false se la coda è piena e la richiesta viene rifiutata.
+		L'evento ApRequest è tracciato solo se il thread chiamante è registrato con
+		Tracer::attach_thread() (i thread dell'executive lo sono già), da chiamare prima delle richieste.
+	*/
+	bool ap_task_request(void* arg = nullptr, unsigned int rel_deadline = 0);
+
+	/* [RUN] Richiede un job della classe aperiodica/sporadica "class_id" (senza lock):
+		arg: argomento passato al task per questa richiesta.
+		Restituisce false se la coda è piena; l'accettazione dei job sporadici avviene nel server.
+		Come sopra, l'evento ApRequest richiede un thread chiamante registrato nel Tracer.
+	*/
+	bool ap_task_request(size_t class_id, void* arg);
+
+	/* [RUN] Token di annullamento del job in esecuzione nel thread chiamante (da invocare nella
+		funzione del task; per i task senza politica Abort o Fallback non viene mai annullato):
+		while (!token.cancelled() && ...) { ... }
+	*/
+	static CancelToken cancel_token();
+
+	/* [RUN] Contatori delle richieste aperiodiche aggiornati a ogni frame */
+	ApCounters ap_counters() const;
+
+	/* [RUN] Statistiche di jitter, tempi di risposta e di esecuzione raccolte dall'avvio */
+	Stats stats() const;
+
+	/* [RUN] Utilizzazione dello schedule: frazione dell'iperperiodo occupata dai WCET dei task periodici
+		(RateMonotonic, Edf: somma dei WCET / periodo) */
+	double utilization() const;
+
+	/* [RUN] Slack medio per frame (o per tick), in quanti temporali, calcolato dai WCET */
+	double mean_slack() const;
 
 private:
-    struct TaskData {
-        std::function<void()> function;
-        std::thread thread;
-        std::mutex mtx;
-        std::condition_variable cv;
-        std::mutex state_mtx;
-        State state{State::Idle};
+    /* Blocco di controllo di un task, diviso secondo chi scrive cosa durante l'esecuzione
+       (array paralleli indicizzati per task_id), per evitare false condivisioni tra thread:
+       - TaskData: parte "calda" del passaggio executive -> worker, una linea di cache per task;
+       - TaskConfig: configurazione, di sola lettura dopo lo start;
+       - TaskControl: stato privato del thread executive;
+       - TaskMeasures: misure, scritte solo dal worker che esegue il job. */
+    struct alignas(64) TaskData {
+        // parola di stato (State), usata anche come futex per il rilascio
+        std::atomic<int> state{static_cast<int>(State::Idle)};
+        unsigned int job_tag{0};      // numero (troncato) del frame in cui è stato rilasciato il job
+        std::atomic<int> worker{-1};  // worker del pool che sta eseguendo il job (-1 = nessuno)
+        uint16_t trace_id{0xFFFF};    // id del task nei record di trace
+        std::atomic<bool> over_budget{false};  // budget esaurito: il worker si è già abbassato di priorità
+        std::atomic<bool> cancel{false};       // annullamento richiesto dall'executive (CancelToken)
+        bool fallback{false};                  // il job rilasciato esegue la funzione di riserva
         std::chrono::steady_clock::time_point release_time;
         std::chrono::steady_clock::time_point deadline_time;
+        std::chrono::steady_clock::time_point release_stamp;  // istante effettivo del rilascio
+    };
+
+    struct TaskConfig {
+        Task function;
         unsigned int wcet{0};
+        OverrunPolicy policy{OverrunPolicy::Skip};
+        Task fallback;
+        unsigned int fallback_wcet{0};
+        unsigned int period{0};        // RateMonotonic, Edf (in quanti)
+        unsigned int deadline{0};
+    };
+
+    struct TaskControl {
+        std::thread thread;
+        std::atomic<rt::thread_id> tid{0};  // id del thread nel kernel, pubblicato dal thread all'avvio
+        bool deadline{false};       // thread in SCHED_DEADLINE: l'executive non ne cambia la priorità
+        rt::priority priority;      // priorità attuale del thread (cache)
         unsigned int skip_count{0};
+        bool fallback_next{false};  // Fallback: il prossimo rilascio esegue la funzione di riserva
+        bool release_now{false};    // decisione di rilascio nel frame corrente
+        std::atomic<uint64_t> deadline_misses{0};
+        std::atomic<uint64_t> skipped{0};
+        std::atomic<uint64_t> cancelled{0};
+        std::atomic<uint64_t> fallbacks{0};
     };
 
+    struct alignas(64) TaskMeasures {
+        Histogram latency_hist;
+        Histogram jitter_hist;
+        Histogram response_hist;
+        Histogram exec_hist;
+        std::atomic<uint64_t> budget_overruns{0};
+    };
+
+    static_assert(sizeof(TaskData) == 64, "the hot part of a task must fit one cache line");
+
     std::vector<TaskData> tasks;
+    std::vector<TaskConfig> task_config;
+    std::vector<TaskControl> task_control;
+    std::vector<TaskMeasures> task_measures;
 	TaskData ap_T;
+    TaskControl ap_control;
     std::thread exec_thread;
-    std::vector<std::vector<size_t>> frames;
-	std::vector<int> slack_times;
+    rt::cpu_set cpu_affinity;
+
+    // Schedule del modo 0: tabella statica (set_schedule) o costruita da add_frame nei vettori dyn_*
+    ScheduleTable sched{};
+    bool static_schedule{false};
+    std::vector<uint16_t> dyn_jobs;
+    std::vector<uint32_t> dyn_frame_begin;
+    std::vector<int> dyn_slack;
+    std::vector<long long> dyn_slack_prefix;   // slack cumulativo (prefissi sull'iperperiodo), per il test di accettazione
     unsigned int frame_length;
-    std::chrono::milliseconds unit_time;
-    
-    // Variabile per segnalare richieste aperiodiche
-    bool ap_request_pending{false};
-    std::mutex ap_request_mtx;
-
-    static void task_function(TaskData& T);
-    void exec_function();
+    std::chrono::nanoseconds unit_time;   // tutta l'aritmetica di frame, slack e deadline è in ns
+
+    // Modi operativi (add_mode): il modo attivo è pubblicato in mode_word come
+    // (primo frame del modo << 16) | modo, e cambia solo a un confine di iperperiodo
+    static const size_t NO_MODE = ~static_cast<size_t>(0);
+    std::vector<ScheduleTable> modes;              // modi 1, 2, ...
+    std::atomic<unsigned long long> mode_word{0};
+    std::atomic<size_t> pending_mode{NO_MODE};    // richiesta di change_mode
+
+    // Classe di task aperiodici o sporadici
+    struct ApClass {
+        ApTask function;
+        unsigned int wcet;
+        unsigned int rel_deadline;       // 0 = nessuna deadline
+        unsigned int min_interarrival;
+        bool sporadic;
+        std::chrono::steady_clock::time_point last_arrival;
+    };
+
+    // Richiesta aperiodica: accodata dal richiedente, servita dal server nello slack
+    struct ApJob {
+        size_t class_id;
+        void* arg;
+        std::chrono::steady_clock::time_point arrival;
+        std::chrono::steady_clock::time_point deadline;
+        unsigned long long seq;
+        bool sporadic;
+    };
+
+    // Il thread di ap_T è il server: unico consumatore della coda, possiede backlog e job accettati
+    std::vector<ApClass> ap_classes;
+    MpscQueue<ApJob> ap_queue;
+    std::vector<ApJob> ap_backlog;    // heap: sporadici per deadline, poi aperiodici secondo ap_order
+    std::vector<ApJob> ap_admitted;   // sporadici accettati e non ancora completati, per deadline
+    std::chrono::nanoseconds ap_blocking{0};   // WCET del job soft in servizio (il server non è preemptive)
+    ApOrder ap_order{ApOrder::FIFO};
+    unsigned long long ap_seq{0};
+
+    std::chrono::steady_clock::time_point hyperperiod_origin;
+    std::atomic<unsigned long long> abs_frame{0}; // numero del frame corrente dall'avvio
+
+    std::atomic<size_t> ap_backlog_size{0};
+    std::atomic<size_t> ap_rejected_total{0};
+    std::atomic<size_t> ap_not_admitted_total{0};
+    std::atomic<size_t> ap_last_depth{0};
+    std::atomic<size_t> ap_last_rejected{0};
+    std::atomic<size_t> ap_last_not_admitted{0};
+    std::atomic<size_t> ap_served_total{0};
+
+    // Recupero dello slack: job periodici del frame corrente ancora da completare
+    std::atomic<unsigned long long> frame_jobs{0};  // (tag del frame << 32) | job rimanenti
+    std::atomic<int> frame_complete{0};             // futex: incrementato quando il frame è completo
+    std::atomic<long long> reclaimed_last{0};       // ns
+    std::atomic<long long> reclaimed_total{0};      // ns
+
+    Histogram ap_response_hist;     // scritto dal server aperiodico
+    Histogram wakeup_hist;          // scritto dal thread executive
+    Histogram exec_cpu_hist;        // scritto dal thread executive
+    Histogram syscall_hist;         // scritto dal thread executive
+    uint64_t exec_syscalls{0};      // syscall dell'executive nel frame corrente
+    std::atomic<uint64_t> frames_run{0};
+    unsigned long long hyperperiod_limit{0};
+    std::atomic<bool> stop_requested{false};   // stop(): il thread executive esce a fine frame
+    std::atomic<bool> stopping{false};         // thread executive terminato: i worker escono
+
+    // Armamento (set_arm) e verifiche di debug
+    bool arm_enabled{false};
+    ArmConfig arm_config;
+    bool memory_locked{false};
+    bool armed{false};                 // arm() già eseguita
+    std::atomic<uint64_t> rt_allocations{0};
+    std::atomic<uint64_t> rt_page_faults{0};
+
+    ExecMode exec_mode{ExecMode::Threads};
+    bool budget_enforcement{false};
+
+    // Backend Deadline (set_sched_backend): start() prenota la banda dei thread prima del primo frame,
+    // mentre il thread executive attende su sched_setup
+    SchedBackend sched_backend{SchedBackend::Fifo};
+    DeadlineConfig deadline_config;
+    std::atomic<rt::thread_id> exec_tid{0};
+    std::atomic<int> sched_setup{0};
+    bool exec_deadline{false};
+    uint64_t deadline_fallbacks{0};
+
+    // Politiche a priorità (set_policy): rilasci futuri in un heap (tick, task_id), job rilasciati e
+    // non ancora verificati in prio_active; tutto privato del thread executive, riservato da start()
+    SchedPolicy sched_policy{SchedPolicy::Cyclic};
+    unsigned long long hyperperiod_ticks{1};
+    std::vector<std::pair<unsigned long long, uint32_t>> release_heap;
+    std::vector<uint32_t> prio_active;
+    std::vector<uint32_t> prio_released;
+    std::vector<uint32_t> prio_rank;
+    std::vector<rt::priority> rm_priority;   // [num_tasks]
+
+    // Pool di worker: lista del frame corrente = job del frame frame_id nella tabella, consumati in ordine
+    struct PoolWorker {
+        std::thread thread;
+        rt::priority priority;            // priorità attuale (cache, la modifica solo il worker)
+        std::atomic<bool> demoted{false}; // abbassata dall'executive per un job in ritardo
+    };
+    static const unsigned long long POOL_CLOSED = ~0ull;
+    std::vector<PoolWorker> pool;
+    size_t pool_size{0};
+    std::atomic<unsigned long long> pool_cursor{POOL_CLOSED};  // (frame_id << 32) | prossimo indice
+    std::atomic<int> pool_epoch{0};                            // futex: incrementato a ogni frame
+    std::atomic<bool> pool_ap_running{false};
+
+    // Tempo e attese del thread executive (timer dei frame, futex, priorità): reale o simulato
+    RealClock real_clock;
+    ExecClock* clock{&real_clock};
+    std::atomic<uint64_t> timer_overruns{0};
+
+    void sync_schedule();
+    const ScheduleTable& mode_table(size_t mode) const { return mode == 0 ? sched : modes[mode - 1]; }
+    const ScheduleTable& active_table() const;
+    void dismiss_workers();
+    bool deadline_requested() const;
+    void setup_deadline();
+    bool reserve(TaskControl& C, const rt::deadline_params& p);
+    void arm_thread();
+    void rt_check(uint16_t trace_id);
+    static rt::priority plan_priority(size_t pos, bool ap_running);
+    void task_function(size_t tid);
+    bool run_job(size_t tid, rt::cpu_budget* budget);
+    void pool_function(size_t w);
+    void start_pool();
+    void demote_worker(TaskData& T);
+    static LatencyStats summarize(const Histogram& h);
+    void prepare_priority_driven();
+    void priority_loop(std::chrono::steady_clock::time_point start_time, unsigned long long missed);
+    void arm_job(size_t tid, unsigned int tag, std::chrono::steady_clock::time_point release_time,
+                 std::chrono::steady_clock::time_point deadline_time);
+    void check_deadline(size_t tid);
+    size_t ap_frame_counters(size_t& rejected_seen, size_t& not_admitted_seen);
+    void job_completed(unsigned int tag);
+    static bool wait_release(TaskData& T);
+    static void job_done(TaskData& T);
+    void release(TaskData& T);
+    bool simulated() const { return clock != &real_clock; }
+    void set_priority(TaskControl& C, uint16_t trace_id, const rt::priority& p);
+    bool decide_release(size_t tid);
+    static State get_state(const TaskData& T);
+    void exec_function(std::chrono::steady_clock::time_point start_time);
+    uint64_t run_frame_inline(size_t frame_id, unsigned int tag,
+                          std::chrono::steady_clock::time_point frame_start,
+                          std::chrono::steady_clock::time_point frame_end);
+    void ap_server_function();
+    bool ap_next(ApJob& job);
+    void ap_finish(const ApJob& job);
+    void drain_ap_queue();
+    bool ap_push(const ApJob& job);
+    bool ap_admit(const ApJob& job, std::chrono::steady_clock::time_point now);
+    std::chrono::nanoseconds slack_until(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point deadline) const;
+    bool ap_job_later(const ApJob& a, const ApJob& b) const;
 };
 
 #endif // EXECUTIVE_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+// Fixed-memory log-linear histogram of non-negative values (e.g. nanoseconds).
+// Values below 2^SUB_BITS get one bucket each; every following power-of-two range is split
+// into 2^(SUB_BITS-1) linear buckets, so the relative error is below 1/2^(SUB_BITS-1) (~6%).
+// Values above 2^MAX_BITS are clamped. A single thread records (no read-modify-write);
+// any thread can read a consistent-enough snapshot at the same time.
+class Histogram
+{
+	public:
+		static const unsigned int SUB_BITS = 5;
+		static const unsigned int MAX_BITS = 40;
+		static const unsigned int SUB = 1u << SUB_BITS;
+		static const unsigned int HALF = SUB / 2;
+		static const unsigned int BUCKETS = SUB + (MAX_BITS - SUB_BITS) * HALF;
+
+		Histogram()
+		{
+			for (auto & b : buckets)
+				b.store(0, std::memory_order_relaxed);
+		}
+
+		void record(uint64_t value)
+		{
+			if (value >> MAX_BITS)
+				value = (uint64_t(1) << MAX_BITS) - 1;
+
+			auto & b = buckets[index(value)];
+			b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+			total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+			if (value > maximum.load(std::memory_order_relaxed))
+				maximum.store(value, std::memory_order_relaxed);
+			if (value < minimum.load(std::memory_order_relaxed))
+				minimum.store(value, std::memory_order_relaxed);
+		}
+
+		uint64_t count() const { return total.load(std::memory_order_relaxed); }
+
+		uint64_t max() const { return maximum.load(std::memory_order_relaxed); }
+
+		uint64_t min() const
+		{
+			return count() ? minimum.load(std::memory_order_relaxed) : 0;
+		}
+
+		double mean() const
+		{
+			uint64_t n = count();
+			return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+		}
+
+		// upper bound of the bucket holding the p-th percentile (p in [0, 100]), capped at max()
+		uint64_t percentile(double p) const
+		{
+			uint64_t n = count();
+			if (n == 0)
+				return 0;
+
+			uint64_t rank = static_cast<uint64_t>(p / 100.0 * n + 0.5);
+			if (rank < 1)
+				rank = 1;
+			if (rank > n)
+				rank = n;
+
+			uint64_t seen = 0;
+			for (unsigned int i = 0; i < BUCKETS; ++i)
+			{
+				seen += buckets[i].load(std::memory_order_relaxed);
+				if (seen >= rank)
+					return upper_bound(i) < max() ? upper_bound(i) : max();
+			}
+			return max();
+		}
+
+	private:
+		static unsigned int index(uint64_t v)
+		{
+			if (v < SUB)
+				return static_cast<unsigned int>(v);
+
+			unsigned int msb = 63 - __builtin_clzll(v);
+			unsigned int shift = msb - SUB_BITS + 1;
+			return SUB + (shift - 1) * HALF + static_cast<unsigned int>((v >> shift) - HALF);
+		}
+
+		static uint64_t upper_bound(unsigned int i)
+		{
+			if (i < SUB)
+				return i;
+
+			unsigned int shift = (i - SUB) / HALF + 1;
+			uint64_t sub = (i - SUB) % HALF + HALF;
+			return ((sub + 1) << shift) - 1;
+		}
+
+		std::atomic<uint64_t> buckets[BUCKETS];
+		std::atomic<uint64_t> total{0};
+		std::atomic<uint64_t> sum{0};
+		std::atomic<uint64_t> maximum{0};
+		std::atomic<uint64_t> minimum{std::numeric_limits<uint64_t>::max()};
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef INLINE_FUNCTION_H
+#define INLINE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only, type-erased callable stored entirely inside the object (no heap allocation, ever).
+// Accepts function pointers, "function pointer + context" pairs and lambdas / function objects
+// whose size and alignment fit the fixed Capacity; anything larger is rejected at compile time.
+// A call costs one indirect call, like a plain function pointer.
+template <typename Signature, size_t Capacity = 32>
+class InlineFunction;
+
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity>
+{
+	public:
+		InlineFunction() = default;
+
+		InlineFunction(std::nullptr_t) {}
+
+		// function pointer taking an opaque context as first argument
+		InlineFunction(R (*fn)(void *, Args...), void * context)
+		{
+			emplace(ContextCall{fn, context});
+		}
+
+		template <typename F,
+		          typename D = typename std::decay<F>::type,
+		          typename = typename std::enable_if<!std::is_same<D, InlineFunction>::value
+		                                             && std::is_invocable_r<R, D &, Args...>::value>::type>
+		InlineFunction(F && f)
+		{
+			emplace(std::forward<F>(f));
+		}
+
+		InlineFunction(InlineFunction && other) noexcept
+		{
+			move_from(other);
+		}
+
+		InlineFunction & operator =(InlineFunction && other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				move_from(other);
+			}
+			return *this;
+		}
+
+		InlineFunction(const InlineFunction &) = delete;
+		InlineFunction & operator =(const InlineFunction &) = delete;
+
+		~InlineFunction() { reset(); }
+
+		explicit operator bool() const { return invoke != nullptr; }
+
+		R operator ()(Args... args) const
+		{
+			return invoke(storage(), std::forward<Args>(args)...);
+		}
+
+		void reset()
+		{
+			if (manage)
+				manage(storage(), nullptr);
+			invoke = nullptr;
+			manage = nullptr;
+		}
+
+	private:
+		struct ContextCall
+		{
+			R (*fn)(void *, Args...);
+			void * context;
+
+			R operator ()(Args... args) const { return fn(context, std::forward<Args>(args)...); }
+		};
+
+		template <typename F>
+		void emplace(F && f)
+		{
+			typedef typename std::decay<F>::type D;
+			static_assert(sizeof(D) <= Capacity, "callable too large for InlineFunction: reduce captures or raise Capacity");
+			static_assert(alignof(D) <= alignof(std::max_align_t), "over-aligned callable");
+			static_assert(std::is_nothrow_move_constructible<D>::value, "callable must be nothrow move constructible");
+
+			::new (storage()) D(std::forward<F>(f));
+
+			invoke = [](void * s, Args... args) -> R {
+				return (*static_cast<D *>(s))(std::forward<Args>(args)...);
+			};
+
+			// dst == nullptr: destroy src; otherwise move-construct dst from src and destroy src
+			manage = [](void * src, void * dst) {
+				D * from = static_cast<D *>(src);
+				if (dst)
+					::new (dst) D(std::move(*from));
+				from->~D();
+			};
+		}
+
+		void move_from(InlineFunction & other)
+		{
+			if (other.manage)
+				other.manage(other.storage(), storage());
+			invoke = other.invoke;
+			manage = other.manage;
+			other.invoke = nullptr;
+			other.manage = nullptr;
+		}
+
+		void * storage() const { return const_cast<unsigned char *>(buffer); }
+
+		alignas(std::max_align_t) unsigned char buffer[Capacity];
+		R (*invoke)(void *, Args...) = nullptr;
+		void (*manage)(void *, void *) = nullptr;
+};
+
+#endif
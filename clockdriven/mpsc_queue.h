@@ -0,0 +1,103 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded multi-producer / single-consumer ring buffer (sequence-numbered cells).
+// push() is lock-free and may be called concurrently from any thread;
+// pop() must only be called by a single consumer thread.
+template <typename T>
+class MpscQueue
+{
+	public:
+		explicit MpscQueue(size_t capacity = 64) { init(capacity); }
+
+		// (re)allocates the ring, rounding the capacity up to a power of two;
+		// not thread safe: only call it before producers and consumer are running
+		void init(size_t capacity)
+		{
+			size_t n = 2;
+			while (n < capacity)
+				n <<= 1;
+
+			cells.reset(new Cell[n]);
+			for (size_t i = 0; i < n; ++i)
+				cells[i].seq.store(i, std::memory_order_relaxed);
+
+			mask = n - 1;
+			enqueue_pos.store(0, std::memory_order_relaxed);
+			dequeue_pos.store(0, std::memory_order_relaxed);
+		}
+
+		size_t capacity() const { return mask + 1; }
+
+		// returns false (without blocking) when the ring is full
+		bool push(const T & value)
+		{
+			size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				Cell & c = cells[pos & mask];
+				size_t seq = c.seq.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+				if (diff == 0)
+				{
+					if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						c.data = value;
+						c.seq.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+					return false;
+				else
+					pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		// returns false when the ring is empty (or the oldest push is not yet complete)
+		bool pop(T & value)
+		{
+			size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+			Cell & c = cells[pos & mask];
+			size_t seq = c.seq.load(std::memory_order_acquire);
+
+			if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0)
+				return false;
+
+			value = c.data;
+			c.seq.store(pos + mask + 1, std::memory_order_release);
+			dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// approximate number of queued elements (exact when called by the consumer with no producer active)
+		size_t size() const
+		{
+			size_t e = enqueue_pos.load(std::memory_order_relaxed);
+			size_t d = dequeue_pos.load(std::memory_order_relaxed);
+			return e > d ? e - d : 0;
+		}
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> seq;
+			T data;
+		};
+
+		std::unique_ptr<Cell[]> cells;
+		size_t mask;
+
+		// producers and consumer indices on separate cache lines
+		alignas(64) std::atomic<size_t> enqueue_pos;
+		alignas(64) std::atomic<size_t> dequeue_pos;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "partitioned_executive.h"
+#include <cassert>
+
+Executive & PartitionedExecutive::add_core(unsigned int cpu, size_t num_tasks, unsigned int frame_length, unsigned int unit_duration)
+{
+    return add_core(cpu, num_tasks, frame_length, std::chrono::nanoseconds(std::chrono::milliseconds(unit_duration)));
+}
+
+Executive & PartitionedExecutive::add_core(unsigned int cpu, size_t num_tasks, unsigned int frame_length, std::chrono::nanoseconds unit_duration)
+{
+    Core C;
+    C.cpu = cpu;
+    C.exec.reset(new Executive(num_tasks, frame_length, unit_duration));
+
+    rt::cpu_set a;
+    a.set(cpu);
+    C.exec->set_affinity(a);
+
+    cores.push_back(std::move(C));
+    return *cores.back().exec;
+}
+
+Executive & PartitionedExecutive::core(size_t core)
+{
+    assert(core < cores.size());
+    return *cores[core].exec;
+}
+
+size_t PartitionedExecutive::num_cores() const
+{
+    return cores.size();
+}
+
+void PartitionedExecutive::start(std::chrono::milliseconds start_delay)
+{
+    // istante comune di inizio, fissato dopo l'armamento di tutti gli executive: lascia a tutti
+    // i core il tempo di avviare il proprio executive
+    for (auto& C : cores)
+        C.exec->arm();
+    auto start_time = std::chrono::steady_clock::now() + start_delay;
+    for (auto& C : cores)
+        C.exec->start(start_time);
+}
+
+void PartitionedExecutive::wait()
+{
+    for (auto& C : cores)
+        C.exec->wait();
+}
+
+void PartitionedExecutive::stop()
+{
+    for (auto& C : cores)
+        C.exec->stop();
+}
+
+void PartitionedExecutive::report(std::ostream & out) const
+{
+    for (size_t i = 0; i < cores.size(); ++i) {
+        const Executive& E = *cores[i].exec;
+        Executive::ApCounters c = E.ap_counters();
+        Executive::Stats st = E.stats();
+        out << "[Core " << cores[i].cpu << "] utilizzazione: " << E.utilization() * 100.0 << "%"
+            << ", slack medio per frame: " << E.mean_slack()
+            << ", slack recuperato nell'ultimo frame: " << std::chrono::duration_cast<std::chrono::microseconds>(c.reclaimed).count() << " us"
+            << ", in totale: " << std::chrono::duration_cast<std::chrono::microseconds>(c.reclaimed_total).count() << " us"
+            << ", ritardo del risveglio p99: " << std::chrono::duration_cast<std::chrono::microseconds>(st.wakeup_lateness.p99).count() << " us"
+            << ", frame saltati: " << st.timer_overruns
+            << std::endl;
+    }
+}
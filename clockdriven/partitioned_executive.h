@@ -0,0 +1,53 @@
+#ifndef PARTITIONED_EXECUTIVE_H
+#define PARTITIONED_EXECUTIVE_H
+
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <ostream>
+
+#include "executive.h"
+
+/* Executive partizionato: un Executive per core, ciascuno con i propri task, la propria
+   lista di frame e il proprio thread executive, tutti vincolati al core assegnato.
+   Gli iperperiodi di tutti i core partono dallo stesso istante. */
+class PartitionedExecutive {
+public:
+	/* [INIT] Aggiunge un core con il proprio executive e ne restituisce il riferimento,
+		da usare come un Executive normale (set_periodic_task, add_frame, ...):
+		cpu: indice del core a cui vincolare executive e task;
+		num_tasks, frame_length, unit_duration: come nel costruttore di Executive.
+	*/
+	Executive & add_core(unsigned int cpu, size_t num_tasks, unsigned int frame_length, unsigned int unit_duration = 10);
+	Executive & add_core(unsigned int cpu, size_t num_tasks, unsigned int frame_length, std::chrono::nanoseconds unit_duration);
+
+	/* [INIT] Executive del core di indice "core" (nell'ordine di add_core) */
+	Executive & core(size_t core);
+
+	/* [INIT] Numero di core configurati */
+	size_t num_cores() const;
+
+	/* [RUN] Lancia tutti gli executive con un inizio di iperperiodo comune:
+		start_delay: anticipo con cui viene fissato l'istante di inizio (default 10ms).
+	*/
+	void start(std::chrono::milliseconds start_delay = std::chrono::milliseconds(10));
+
+	/* [RUN] Attende (all'infinito, o fino a stop()) finchè girano gli executive */
+	void wait();
+
+	/* [RUN] Termina tutti gli executive, ciascuno alla fine del proprio frame corrente */
+	void stop();
+
+	/* [RUN] Stampa utilizzazione, slack e slack recuperato di ciascun core */
+	void report(std::ostream & out) const;
+
+private:
+	struct Core {
+		unsigned int cpu;
+		std::unique_ptr<Executive> exec;
+	};
+
+	std::vector<Core> cores;
+};
+
+#endif // PARTITIONED_EXECUTIVE_H
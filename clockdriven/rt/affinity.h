@@ -3,19 +3,106 @@
 
 #include <thread>
 #include <bitset>
+#include <vector>
+#include <string>
 
 namespace rt
 {
 
+// fixed-size affinity mask, limited to the first 32 CPUs
 typedef std::bitset<32> affinity;
 
+// dynamically sized affinity mask, by default sized for every CPU configured on the machine
+class cpu_set
+{
+	public:
+		cpu_set();
+		explicit cpu_set(size_t size);
+		cpu_set(const affinity & a);
+
+		size_t size() const;
+		size_t count() const;
+		bool any() const;
+		bool none() const;
+
+		bool test(size_t cpu) const;
+		bool operator [](size_t cpu) const;
+
+		cpu_set & set(size_t cpu, bool value = true); // grows the set if needed
+		cpu_set & reset(size_t cpu);
+		cpu_set & set();
+		cpu_set & reset();
+
+		cpu_set & operator |=(const cpu_set & s);
+		cpu_set & operator &=(const cpu_set & s);
+		bool operator ==(const cpu_set & s) const;
+		bool operator !=(const cpu_set & s) const;
+
+		// indices of the CPUs in the set, in increasing order
+		std::vector<size_t> cpus() const;
+
+		// kernel "cpulist" format, e.g. "0-3,8,10-11"
+		std::string to_string() const;
+
+	private:
+		std::vector<bool> bits;
+};
+
 affinity get_affinity(const std::thread & th);
 void set_affinity(std::thread & th, const affinity & a);
 
+cpu_set get_cpu_set(const std::thread & th);
+void set_affinity(std::thread & th, const cpu_set & s);
+
 namespace this_thread
 {
 affinity get_affinity();
 void set_affinity(const affinity & a);
+
+cpu_set get_cpu_set();
+void set_affinity(const cpu_set & s);
+}
+
+// ...............................................................................................
+
+inline cpu_set::cpu_set(size_t size) : bits(size, false)
+{
+}
+
+inline cpu_set::cpu_set(const affinity & a) : bits(a.size(), false)
+{
+	for (size_t i = 0; i < a.size(); ++i)
+		bits[i] = a[i];
+}
+
+inline size_t cpu_set::size() const
+{
+	return bits.size();
+}
+
+inline bool cpu_set::test(size_t cpu) const
+{
+	return cpu < bits.size() && bits[cpu];
+}
+
+inline bool cpu_set::operator [](size_t cpu) const
+{
+	return test(cpu);
+}
+
+inline bool cpu_set::none() const
+{
+	return !any();
+}
+
+inline cpu_set & cpu_set::reset(size_t cpu)
+{
+	return set(cpu, false);
+}
+
+inline bool cpu_set::operator !=(const cpu_set & s) const
+{
+	return !(*this == s);
 }
 
 }
@@ -0,0 +1,131 @@
+#include <mutex>
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+#include "budget.h"
+
+namespace rt
+{
+
+void budget_expired(cpu_budget * budget) noexcept
+{
+	if (budget != nullptr)
+		budget->expire();
+}
+
+namespace detail
+{
+
+#ifdef __linux__
+static void budget_signal(int, siginfo_t * info, void *)
+{
+	budget_expired(static_cast<cpu_budget *>(info->si_value.sival_ptr));
+}
+
+static bool install_handler()
+{
+	static std::once_flag once;
+	static bool installed = false;
+	std::call_once(once, []() {
+		struct sigaction sa = {};
+		sa.sa_sigaction = budget_signal;
+		sa.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&sa.sa_mask);
+		installed = sigaction(SIGRTMIN, &sa, nullptr) == 0;
+	});
+	return installed;
+}
+#endif
+
+}
+
+cpu_budget::cpu_budget()
+{
+#ifdef __linux__
+	if (!detail::install_handler())
+		return;
+
+	struct sigevent sev = {};
+	sev.sigev_notify = SIGEV_THREAD_ID;
+	sev.sigev_signo = SIGRTMIN;
+	sev.sigev_value.sival_ptr = this;
+	sev.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+
+	timer_t id;
+	if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &id) == 0)
+	{
+		timer = id;
+		created = true;
+	}
+#endif
+}
+
+cpu_budget::~cpu_budget()
+{
+#ifdef __linux__
+	armed.store(false);
+	if (created)
+		timer_delete(static_cast<timer_t>(timer));
+#endif
+}
+
+void cpu_budget::start(std::chrono::nanoseconds budget, const priority & demote_to, std::atomic<bool> * flag)
+{
+	if (!created || budget.count() <= 0)
+		return;
+
+#ifdef __linux__
+	// the handler only reads plain values: the FIFO priority is converted here
+	demote_param = demote_to.is_rt() ? (demote_to - priority::rt_min) + sched_get_priority_min(SCHED_FIFO) : 0;
+	expired_flag = flag;
+	expired.store(false, std::memory_order_relaxed);
+	armed.store(true, std::memory_order_release);
+
+	struct itimerspec spec = {};
+	spec.it_value.tv_sec = budget.count() / 1000000000;
+	spec.it_value.tv_nsec = budget.count() % 1000000000;
+	timer_settime(static_cast<timer_t>(timer), 0, &spec, nullptr);
+#else
+	(void)demote_to;
+	(void)flag;
+#endif
+}
+
+bool cpu_budget::stop()
+{
+	armed.store(false, std::memory_order_release);
+	return expired.load(std::memory_order_acquire);
+}
+
+void cpu_budget::expire() noexcept
+{
+#ifdef __linux__
+	// signal context, in the owning thread: only async-signal-safe operations
+	if (!armed.exchange(false, std::memory_order_acq_rel))
+		return;
+	if (demote_param > 0)
+	{
+		struct sched_param param = {};
+		param.sched_priority = demote_param;
+		sched_setscheduler(0, SCHED_FIFO, &param);
+	}
+	expired.store(true, std::memory_order_release);
+	if (expired_flag != nullptr)
+		expired_flag->store(true, std::memory_order_release);
+#endif
+}
+
+}
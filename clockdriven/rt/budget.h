@@ -0,0 +1,52 @@
+#ifndef RT_BUDGET_H
+#define RT_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+
+#include "priority.h"
+
+namespace rt
+{
+
+// CPU-time budget of the calling thread: a CLOCK_THREAD_CPUTIME_ID timer whose signal
+// (SIGRTMIN, SA_RESTART) is directed at the thread itself. When the thread has consumed
+// "budget" of CPU time after start(), the handler immediately lowers the thread to the
+// given SCHED_FIFO priority and raises the expiry flags, so that an overrunning job stops
+// delaying the jobs below it. start() costs one timer_settime; stop() is free (it only
+// disarms the handler: a late signal is ignored and the next start() reprograms the timer).
+// Not available (valid() == false) where per-thread CPU timers are missing.
+class cpu_budget
+{
+	public:
+		// creates the timer for the calling thread, which must be the only one to use the object
+		cpu_budget();
+		~cpu_budget();
+
+		cpu_budget(const cpu_budget &) = delete;
+		cpu_budget & operator =(const cpu_budget &) = delete;
+
+		bool valid() const { return created; }
+
+		// starts a budget; on expiry the thread is demoted to "demote_to" (if real-time)
+		// and "flag", if given, is set to true
+		void start(std::chrono::nanoseconds budget, const priority & demote_to, std::atomic<bool> * flag = nullptr);
+
+		// ends the current budget; returns true if it had run out
+		bool stop();
+
+	private:
+		void expire() noexcept;
+		friend void budget_expired(cpu_budget * budget) noexcept;
+
+		bool created{false};
+		void * timer{nullptr};          // timer_t
+		int demote_param{0};            // SCHED_FIFO priority set by the handler (0 = none)
+		std::atomic<bool> armed{false};
+		std::atomic<bool> expired{false};
+		std::atomic<bool> * expired_flag{nullptr};
+};
+
+}
+
+#endif
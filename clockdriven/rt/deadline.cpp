@@ -0,0 +1,105 @@
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "deadline.h"
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+#ifndef SCHED_FLAG_RECLAIM
+#define SCHED_FLAG_RECLAIM 0x02
+#endif
+
+namespace rt
+{
+
+namespace detail
+{
+
+// struct sched_attr of the kernel ABI (not exported by older C libraries)
+struct sched_attr
+{
+	uint32_t size;
+	uint32_t sched_policy;
+	uint64_t sched_flags;
+	int32_t sched_nice;
+	uint32_t sched_priority;
+	uint64_t sched_runtime;
+	uint64_t sched_deadline;
+	uint64_t sched_period;
+};
+
+static void set_deadline(thread_id tid, const deadline_params & p)
+{
+	int res = ENOSYS;
+
+#if defined(__linux__) && defined(SYS_sched_setattr)
+	struct sched_attr attr = {};
+	attr.size = sizeof(attr);
+	attr.sched_policy = SCHED_DEADLINE;
+	attr.sched_flags = p.reclaim ? SCHED_FLAG_RECLAIM : 0;
+	attr.sched_runtime = p.runtime.count();
+	attr.sched_deadline = p.deadline.count();
+	attr.sched_period = p.period.count();
+
+	res = syscall(SYS_sched_setattr, tid, &attr, 0) == 0 ? 0 : errno;
+#else
+	(void)tid;
+	(void)p;
+#endif
+
+	if (res != 0)
+	{
+		char msg[30];
+		throw permission_error(strerror_r(res, msg, 30));
+	}
+}
+
+}
+
+void set_deadline(thread_id tid, const deadline_params & p)
+{
+	detail::set_deadline(tid, p);
+}
+
+bool is_deadline(thread_id tid)
+{
+#ifdef __linux__
+	return sched_getscheduler(tid) == SCHED_DEADLINE;
+#else
+	(void)tid;
+	return false;
+#endif
+}
+
+namespace this_thread
+{
+
+thread_id get_tid()
+{
+#ifdef __linux__
+	return static_cast<thread_id>(syscall(SYS_gettid));
+#else
+	return 0;
+#endif
+}
+
+void set_deadline(const deadline_params & p)
+{
+	detail::set_deadline(0, p);
+}
+
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef RT_DEADLINE_H
+#define RT_DEADLINE_H
+
+#include <chrono>
+
+#include "priority.h"
+
+// SCHED_DEADLINE reservations (Linux >= 3.14): the kernel runs the thread under EDF with
+// a constant-bandwidth server, granting "runtime" of CPU every "period" with a relative
+// "deadline" from each activation, and throttles it when the runtime is used up.
+// Deadline threads run before every SCHED_FIFO thread. The kernel admits a reservation only
+// if the total bandwidth fits (EBUSY otherwise) and only for threads allowed on every CPU of
+// their root domain: the affinity of a deadline thread cannot be restricted.
+
+namespace rt
+{
+
+struct deadline_params
+{
+	std::chrono::nanoseconds runtime;   // >= 1024 ns
+	std::chrono::nanoseconds deadline;  // runtime <= deadline <= period
+	std::chrono::nanoseconds period;
+	bool reclaim;                       // SCHED_FLAG_RECLAIM: may use bandwidth left unused by others (GRUB)
+};
+
+// kernel id of a thread, as accepted by set_deadline()
+typedef int thread_id;
+
+// switches thread "tid" to SCHED_DEADLINE (CAP_SYS_NICE is required)
+void set_deadline(thread_id tid, const deadline_params & p); // throw (permission_error)
+
+// true if thread "tid" is currently a SCHED_DEADLINE thread
+bool is_deadline(thread_id tid);
+
+namespace this_thread
+{
+thread_id get_tid();
+
+void set_deadline(const deadline_params & p); // throw (permission_error)
+}
+
+}
+
+#endif
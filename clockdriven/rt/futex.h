@@ -0,0 +1,21 @@
+#ifndef RT_FUTEX_H
+#define RT_FUTEX_H
+
+#include <atomic>
+#include <chrono>
+
+namespace rt
+{
+
+// blocks the calling thread while "word" still holds "expected" (spurious wake-ups are possible)
+void futex_wait(std::atomic<int> & word, int expected);
+
+// as futex_wait(), but gives up at the absolute time "abs_time"; returns false on timeout
+bool futex_wait_until(std::atomic<int> & word, int expected, const std::chrono::steady_clock::time_point & abs_time);
+
+// wakes up to "count" threads blocked on "word"
+void futex_wake(std::atomic<int> & word, int count = 1);
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <alloca.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "memory.h"
+
+namespace rt
+{
+
+namespace detail
+{
+
+static size_t page_size()
+{
+#ifdef __linux__
+	long size = sysconf(_SC_PAGESIZE);
+	return size > 0 ? static_cast<size_t>(size) : 4096;
+#else
+	return 4096;
+#endif
+}
+
+}
+
+const char * to_string(memory_lock mode)
+{
+	switch (mode)
+	{
+		case memory_lock::none: return "none";
+		case memory_lock::all: return "all";
+		case memory_lock::touched: return "touched";
+	}
+	return "?";
+}
+
+bool lock_memory(memory_lock mode)
+{
+#ifdef __linux__
+	if (mode == memory_lock::none)
+		return true;
+#ifdef MCL_ONFAULT
+	if (mode == memory_lock::touched)
+	{
+		if (mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT) == 0)
+			return true;
+		// kernels before 4.4 reject the flag: lock everything instead
+	}
+#endif
+	return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+	return mode == memory_lock::none;
+#endif
+}
+
+void unlock_memory()
+{
+#ifdef __linux__
+	munlockall();
+#endif
+}
+
+__attribute__((noinline)) void prefault_stack(size_t bytes)
+{
+#ifdef __linux__
+	// the block lies below the caller's frame: the pages the caller's callees will use
+	volatile char * block = static_cast<volatile char *>(alloca(bytes));
+	const size_t page = detail::page_size();
+	for (size_t i = 0; i < bytes; i += page)
+		block[i] = 0;
+	if (bytes > 0)
+		block[bytes - 1] = 0;
+#else
+	(void)bytes;
+#endif
+}
+
+void reserve_heap(size_t bytes)
+{
+	if (bytes == 0)
+		return;
+#ifdef __linux__
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+#endif
+	char * block = static_cast<char *>(std::malloc(bytes));
+	if (block == nullptr)
+		return;
+	volatile char * touch = block;
+	const size_t page = detail::page_size();
+	for (size_t i = 0; i < bytes; i += page)
+		touch[i] = 0;
+	std::free(block);
+}
+
+page_faults thread_page_faults()
+{
+	page_faults f{0, 0};
+#ifdef __linux__
+	struct rusage usage;
+	if (getrusage(RUSAGE_THREAD, &usage) == 0)
+	{
+		f.minor = static_cast<uint64_t>(usage.ru_minflt);
+		f.major = static_cast<uint64_t>(usage.ru_majflt);
+	}
+#endif
+	return f;
+}
+
+}
@@ -0,0 +1,47 @@
+#ifndef RT_MEMORY_H
+#define RT_MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Memory residency for real-time threads: page locking, prefaulting and fault counters
+// (every function degrades to a no-op, or to zero counters, where it is not supported)
+
+namespace rt
+{
+
+enum class memory_lock
+{
+	none,
+	all,      // every current and future page, populated at once (mlockall)
+	touched   // only pages already present or touched later (MCL_ONFAULT): cheap with many
+	          // thread stacks, relies on prefault_stack()/reserve_heap() for the pages in use;
+	          // same as "all" on kernels without MCL_ONFAULT
+};
+
+const char * to_string(memory_lock mode);
+
+// locks the process' pages in RAM; false when not permitted (CAP_IPC_LOCK, RLIMIT_MEMLOCK)
+bool lock_memory(memory_lock mode);
+void unlock_memory();
+
+// writes one byte per page over the next "bytes" of the calling thread's stack,
+// so that deeper calls do not take page faults
+void prefault_stack(size_t bytes);
+
+// keeps "bytes" of touched heap in the allocator for later allocations: disables heap trimming
+// and mmap-backed blocks (glibc), then allocates, touches and frees one block
+void reserve_heap(size_t bytes);
+
+struct page_faults
+{
+	uint64_t minor;
+	uint64_t major;
+};
+
+// page faults taken so far by the calling thread
+page_faults thread_page_faults();
+
+}
+
+#endif
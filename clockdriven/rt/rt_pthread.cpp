@@ -9,9 +9,19 @@
 #include <pthread.h>
 #include <sched.h>
 #include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
 
 #include "priority.h"
 #include "affinity.h"
+#include "futex.h"
 
 namespace rt
 {
@@ -67,42 +77,63 @@ static void set_priority(pthread_t pthread_id, const priority & p)
 	}
 }
 
-static affinity get_affinity(pthread_t pthread_id)
+static cpu_set get_cpu_set(pthread_t pthread_id)
 {
-	affinity a;
+	cpu_set s;
 
 #ifdef __linux__
-	cpu_set_t * cpuset = CPU_ALLOC(a.size());
-	
-	pthread_getaffinity_np(pthread_id, CPU_ALLOC_SIZE(a.size()), cpuset);
+	// the kernel mask can be larger than the configured CPUs: grow until it fits
+	for (size_t n = std::max<size_t>(s.size(), 64); n <= (1u << 16); n *= 2)
+	{
+		cpu_set_t * cpuset = CPU_ALLOC(n);
+		int res = pthread_getaffinity_np(pthread_id, CPU_ALLOC_SIZE(n), cpuset);
 
-	for (size_t i = 0; i < a.size(); ++i)
-		a[i] = CPU_ISSET_S(i, CPU_ALLOC_SIZE(a.size()), cpuset);
+		if (res == 0)
+		{
+			for (size_t i = 0; i < n; ++i)
+				if (CPU_ISSET_S(i, CPU_ALLOC_SIZE(n), cpuset))
+					s.set(i);
+		}
 
-	CPU_FREE(cpuset);
+		CPU_FREE(cpuset);
+
+		if (res != EINVAL)
+			break;
+	}
 #else
-	a.set();
+	s.set();
 #endif
-	return a;
+	return s;
 }
 
-static void set_affinity(pthread_t pthread_id, const affinity & a)
+static void set_affinity(pthread_t pthread_id, const cpu_set & s)
 {
 #ifdef __linux__
-	cpu_set_t * cpuset = CPU_ALLOC(a.size());
+	size_t n = std::max<size_t>(s.size(), 1);
+	cpu_set_t * cpuset = CPU_ALLOC(n);
 
-	CPU_ZERO_S(CPU_ALLOC_SIZE(a.size()), cpuset);
+	CPU_ZERO_S(CPU_ALLOC_SIZE(n), cpuset);
 
-	for (size_t i = 0; i < a.size(); ++i)
-		if (a[i])
-			CPU_SET_S(i, CPU_ALLOC_SIZE(a.size()), cpuset);
+	for (size_t i = 0; i < s.size(); ++i)
+		if (s[i])
+			CPU_SET_S(i, CPU_ALLOC_SIZE(n), cpuset);
 
-	pthread_setaffinity_np(pthread_id, CPU_ALLOC_SIZE(a.size()), cpuset);
+	pthread_setaffinity_np(pthread_id, CPU_ALLOC_SIZE(n), cpuset);
 
 	CPU_FREE(cpuset);
 #endif
 }
 
+static affinity to_affinity(const cpu_set & s)
+{
+	affinity a;
+
+	for (size_t i = 0; i < a.size(); ++i)
+		a[i] = s[i];
+
+	return a;
+}
+
 }
 
 priority get_priority(const std::thread & th)
@@ -117,12 +148,22 @@ void set_priority(std::thread & th, const priority & p)
 
 affinity get_affinity(const std::thread & th)
 {
-	return detail::get_affinity(const_cast<std::thread &>(th).native_handle());
+	return detail::to_affinity(get_cpu_set(th));
 }
 
 void set_affinity(std::thread & th, const affinity & a)
 {
-	detail::set_affinity(th.native_handle(), a);
+	detail::set_affinity(th.native_handle(), cpu_set(a));
+}
+
+cpu_set get_cpu_set(const std::thread & th)
+{
+	return detail::get_cpu_set(const_cast<std::thread &>(th).native_handle());
+}
+
+void set_affinity(std::thread & th, const cpu_set & s)
+{
+	detail::set_affinity(th.native_handle(), s);
 }
 
 
@@ -141,14 +182,69 @@ void set_priority(const priority & p)
 
 affinity get_affinity()
 {
-	return detail::get_affinity(pthread_self());
+	return detail::to_affinity(get_cpu_set());
 }
 
 void set_affinity(const affinity & a)
 {
-	detail::set_affinity(pthread_self(), a);
+	detail::set_affinity(pthread_self(), cpu_set(a));
+}
+
+cpu_set get_cpu_set()
+{
+	return detail::get_cpu_set(pthread_self());
+}
+
+void set_affinity(const cpu_set & s)
+{
+	detail::set_affinity(pthread_self(), s);
+}
+
+}
+
+void futex_wait(std::atomic<int> & word, int expected)
+{
+#ifdef __linux__
+	static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex word must be a plain int");
+
+	syscall(SYS_futex, reinterpret_cast<int *>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+	while (word.load(std::memory_order_acquire) == expected)
+		std::this_thread::yield();
+#endif
 }
 
+bool futex_wait_until(std::atomic<int> & word, int expected, const std::chrono::steady_clock::time_point & abs_time)
+{
+#ifdef __linux__
+	// steady_clock is CLOCK_MONOTONIC, the clock used by FUTEX_WAIT_BITSET for absolute timeouts
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(abs_time.time_since_epoch()).count();
+	if (ns < 0)
+		ns = 0;
+
+	struct timespec ts;
+	ts.tv_sec = ns / 1000000000;
+	ts.tv_nsec = ns % 1000000000;
+
+	long res = syscall(SYS_futex, reinterpret_cast<int *>(&word), FUTEX_WAIT_BITSET_PRIVATE, expected, &ts, nullptr, FUTEX_BITSET_MATCH_ANY);
+
+	return !(res == -1 && errno == ETIMEDOUT);
+#else
+	while (word.load(std::memory_order_acquire) == expected)
+	{
+		if (std::chrono::steady_clock::now() >= abs_time)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+#endif
+}
+
+void futex_wake(std::atomic<int> & word, int count)
+{
+#ifdef __linux__
+	syscall(SYS_futex, reinterpret_cast<int *>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#endif
 }
 
 }
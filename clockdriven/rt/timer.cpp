@@ -0,0 +1,176 @@
+#include <thread>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+#include "timer.h"
+
+namespace rt
+{
+
+namespace detail
+{
+
+#ifdef __linux__
+static struct timespec to_timespec(const std::chrono::steady_clock::time_point & t)
+{
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+	if (ns < 0)
+		ns = 0;
+
+	struct timespec ts;
+	ts.tv_sec = ns / 1000000000;
+	ts.tv_nsec = ns % 1000000000;
+	return ts;
+}
+#endif
+
+}
+
+const char * to_string(timer_backend backend)
+{
+	switch (backend)
+	{
+		case timer_backend::sleep: return "sleep";
+		case timer_backend::nanosleep: return "nanosleep";
+		case timer_backend::timerfd: return "timerfd";
+	}
+	return "?";
+}
+
+void sleep_until(const std::chrono::steady_clock::time_point & abs_time)
+{
+#ifdef __linux__
+	// steady_clock is CLOCK_MONOTONIC: an absolute deadline does not accumulate conversion errors
+	struct timespec ts = detail::to_timespec(abs_time);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+		;
+#else
+	std::this_thread::sleep_until(abs_time);
+#endif
+}
+
+void spin_until(const std::chrono::steady_clock::time_point & abs_time)
+{
+	while (std::chrono::steady_clock::now() < abs_time)
+		;
+}
+
+frame_timer::frame_timer(timer_backend backend, std::chrono::nanoseconds spin_tail)
+	: type(backend), tail(spin_tail.count() > 0 ? spin_tail : std::chrono::nanoseconds(0))
+{
+#ifdef __linux__
+	if (type == timer_backend::timerfd)
+	{
+		fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if (fd < 0)
+			throw std::runtime_error("timerfd_create failed");
+	}
+#else
+	if (type == timer_backend::timerfd)
+		type = timer_backend::nanosleep;
+#endif
+}
+
+frame_timer::~frame_timer()
+{
+#ifdef __linux__
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+void frame_timer::arm(const std::chrono::steady_clock::time_point & first, std::chrono::nanoseconds period_)
+{
+	period = period_;
+	next_time = first;
+
+	// the spin tail must leave something to sleep in every period
+	if (tail >= period)
+		tail = period / 2;
+
+#ifdef __linux__
+	if (type == timer_backend::timerfd)
+	{
+		// the kernel timer fires "tail" early; the rest of the wait is spent spinning
+		struct itimerspec spec;
+		spec.it_value = detail::to_timespec(first - tail);
+		spec.it_interval.tv_sec = period.count() / 1000000000;
+		spec.it_interval.tv_nsec = period.count() % 1000000000;
+		if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+			spec.it_value.tv_nsec = 1;  // a zero it_value would disarm the timer
+
+		if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr) != 0)
+			throw std::runtime_error("timerfd_settime failed");
+	}
+#endif
+}
+
+unsigned long long frame_timer::wait_next()
+{
+	unsigned long long missed = 0;
+
+#ifdef __linux__
+	if (type == timer_backend::timerfd)
+	{
+		// the counter read from the timerfd holds every expiration since the last read
+		uint64_t expirations = 0;
+		while (read(fd, &expirations, sizeof(expirations)) != static_cast<ssize_t>(sizeof(expirations)))
+			if (errno != EINTR)
+				throw std::runtime_error("timerfd read failed");
+
+		missed = expirations > 0 ? expirations - 1 : 0;
+		next_time += missed * period;
+		if (tail.count() > 0)
+			spin_until(next_time);
+
+		next_time += period;
+		return missed;
+	}
+#endif
+
+	auto now = std::chrono::steady_clock::now();
+	if (now >= next_time + period)
+	{
+		missed = (now - next_time) / period;
+		next_time += missed * period;
+	}
+
+	if (tail.count() > 0)
+	{
+		if (type == timer_backend::sleep)
+			std::this_thread::sleep_until(next_time - tail);
+		else
+			rt::sleep_until(next_time - tail);
+		spin_until(next_time);
+	}
+	else if (type == timer_backend::sleep)
+		std::this_thread::sleep_until(next_time);
+	else
+		rt::sleep_until(next_time);
+
+	next_time += period;
+	return missed;
+}
+
+void frame_timer::sleep_until(const std::chrono::steady_clock::time_point & abs_time) const
+{
+	if (type == timer_backend::sleep)
+	{
+		std::this_thread::sleep_until(abs_time - tail);
+		spin_until(abs_time);
+		return;
+	}
+
+	rt::sleep_until(abs_time - tail);
+	if (tail.count() > 0)
+		spin_until(abs_time);
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef RT_TIMER_H
+#define RT_TIMER_H
+
+#include <chrono>
+
+namespace rt
+{
+
+enum class timer_backend
+{
+	sleep,      // std::this_thread::sleep_until (relative nanosleep: lateness grows with the conversion)
+	nanosleep,  // absolute clock_nanosleep on CLOCK_MONOTONIC
+	timerfd     // periodic CLOCK_MONOTONIC timerfd: missed expirations are counted by the kernel
+};
+
+const char * to_string(timer_backend backend);
+
+// Periodic timer marking frame boundaries on steady_clock (CLOCK_MONOTONIC).
+// Every backend can finish with a busy-wait: the thread wakes up "spin_tail" before the
+// boundary and spins on the clock for the rest, trading CPU time for wake-up precision.
+// Boundaries are never shifted: a late wake-up is reported as missed boundaries, not as drift.
+class frame_timer
+{
+	public:
+		explicit frame_timer(timer_backend backend = timer_backend::nanosleep,
+		                     std::chrono::nanoseconds spin_tail = std::chrono::nanoseconds(0));
+		~frame_timer();
+
+		frame_timer(const frame_timer &) = delete;
+		frame_timer & operator =(const frame_timer &) = delete;
+
+		// arms the timer: first boundary at "first", then one every "period"
+		void arm(const std::chrono::steady_clock::time_point & first, std::chrono::nanoseconds period);
+
+		// blocks until the next boundary; returns how many boundaries passed before it
+		// without being waited for (0 when the caller is on time)
+		unsigned long long wait_next();
+
+		// the boundary the next wait_next() will wait for
+		std::chrono::steady_clock::time_point next() const { return next_time; }
+
+		// one-shot absolute sleep with the same precision (clock_nanosleep + spin tail),
+		// independent of the periodic boundaries
+		void sleep_until(const std::chrono::steady_clock::time_point & abs_time) const;
+
+		timer_backend backend() const { return type; }
+		std::chrono::nanoseconds spin_tail() const { return tail; }
+
+	private:
+		timer_backend type;
+		std::chrono::nanoseconds tail;
+		std::chrono::nanoseconds period{0};
+		std::chrono::steady_clock::time_point next_time;
+		int fd{-1};
+};
+
+// absolute sleep on CLOCK_MONOTONIC, restarted after signals
+void sleep_until(const std::chrono::steady_clock::time_point & abs_time);
+
+// busy-waits until "abs_time"
+void spin_until(const std::chrono::steady_clock::time_point & abs_time);
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <unistd.h>
+#include <dirent.h>
+#include <algorithm>
+#include <cctype>
+
+#include "topology.h"
+
+namespace rt
+{
+
+namespace detail
+{
+
+// first line of a /sys file ("" if it cannot be read)
+static std::string read_line(const std::string & path)
+{
+	std::ifstream in(path.c_str());
+	std::string line;
+
+	std::getline(in, line);
+
+	return line;
+}
+
+static std::string cpu_path(size_t cpu)
+{
+	std::ostringstream path;
+	path << "/sys/devices/system/cpu/cpu" << cpu;
+	return path.str();
+}
+
+}
+
+// ...............................................................................................
+
+cpu_set::cpu_set() : bits(configured_cpus(), false)
+{
+}
+
+size_t cpu_set::count() const
+{
+	return std::count(bits.begin(), bits.end(), true);
+}
+
+bool cpu_set::any() const
+{
+	return std::find(bits.begin(), bits.end(), true) != bits.end();
+}
+
+cpu_set & cpu_set::set(size_t cpu, bool value)
+{
+	if (cpu >= bits.size())
+	{
+		if (!value)
+			return *this;
+		bits.resize(cpu + 1, false);
+	}
+
+	bits[cpu] = value;
+	return *this;
+}
+
+cpu_set & cpu_set::set()
+{
+	std::fill(bits.begin(), bits.end(), true);
+	return *this;
+}
+
+cpu_set & cpu_set::reset()
+{
+	std::fill(bits.begin(), bits.end(), false);
+	return *this;
+}
+
+cpu_set & cpu_set::operator |=(const cpu_set & s)
+{
+	for (size_t i = 0; i < s.size(); ++i)
+		if (s[i])
+			set(i);
+	return *this;
+}
+
+cpu_set & cpu_set::operator &=(const cpu_set & s)
+{
+	for (size_t i = 0; i < bits.size(); ++i)
+		bits[i] = bits[i] && s[i];
+	return *this;
+}
+
+bool cpu_set::operator ==(const cpu_set & s) const
+{
+	size_t n = std::max(bits.size(), s.size());
+
+	for (size_t i = 0; i < n; ++i)
+		if (test(i) != s.test(i))
+			return false;
+	return true;
+}
+
+std::vector<size_t> cpu_set::cpus() const
+{
+	std::vector<size_t> v;
+
+	for (size_t i = 0; i < bits.size(); ++i)
+		if (bits[i])
+			v.push_back(i);
+	return v;
+}
+
+std::string cpu_set::to_string() const
+{
+	std::ostringstream out;
+	size_t i = 0;
+
+	while (i < bits.size())
+	{
+		if (!bits[i])
+		{
+			++i;
+			continue;
+		}
+
+		size_t first = i;
+		while (i + 1 < bits.size() && bits[i + 1])
+			++i;
+
+		if (out.tellp() > 0)
+			out << ',';
+		out << first;
+		if (i > first)
+			out << '-' << i;
+		++i;
+	}
+
+	return out.str();
+}
+
+// ...............................................................................................
+
+size_t configured_cpus()
+{
+	long n = sysconf(_SC_NPROCESSORS_CONF);
+	return n > 0 ? n : 1;
+}
+
+cpu_set parse_cpu_list(const std::string & list)
+{
+	cpu_set s(configured_cpus());
+	std::istringstream in(list);
+	std::string range;
+
+	while (std::getline(in, range, ','))
+	{
+		if (range.empty() || !isdigit(static_cast<unsigned char>(range[0])))
+			continue;
+
+		char * end = nullptr;
+		size_t first = std::strtoul(range.c_str(), &end, 10);
+		size_t last = (*end == '-') ? std::strtoul(end + 1, nullptr, 10) : first;
+
+		for (size_t cpu = first; cpu <= last; ++cpu)
+			s.set(cpu);
+	}
+
+	return s;
+}
+
+cpu_set online_cpus()
+{
+	std::string list = detail::read_line("/sys/devices/system/cpu/online");
+
+	if (list.empty())
+	{
+		cpu_set s;
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+		for (long i = 0; i < n; ++i)
+			s.set(i);
+		return s;
+	}
+
+	return parse_cpu_list(list);
+}
+
+cpu_set isolated_cpus()
+{
+	return parse_cpu_list(detail::read_line("/sys/devices/system/cpu/isolated"));
+}
+
+cpu_set core_siblings(size_t cpu)
+{
+	cpu_set s = parse_cpu_list(detail::read_line(detail::cpu_path(cpu) + "/topology/thread_siblings_list"));
+
+	if (s.none())
+		s.set(cpu);
+	return s;
+}
+
+int numa_node(size_t cpu)
+{
+	// the node is exposed as a "nodeN" link inside the cpu directory
+	DIR * dir = opendir(detail::cpu_path(cpu).c_str());
+	int node = 0;
+
+	if (dir == nullptr)
+		return node;
+
+	while (struct dirent * entry = readdir(dir))
+	{
+		std::string name = entry->d_name;
+		if (name.size() > 4 && name.compare(0, 4, "node") == 0 && isdigit(static_cast<unsigned char>(name[4])))
+		{
+			node = std::atoi(name.c_str() + 4);
+			break;
+		}
+	}
+
+	closedir(dir);
+	return node;
+}
+
+cpu_set node_cpus(int node)
+{
+	std::ostringstream path;
+	path << "/sys/devices/system/node/node" << node << "/cpulist";
+
+	std::string list = detail::read_line(path.str());
+
+	if (list.empty())
+		return node == 0 ? online_cpus() : cpu_set();
+
+	return parse_cpu_list(list);
+}
+
+}
+
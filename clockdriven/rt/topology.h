@@ -0,0 +1,38 @@
+#ifndef RT_TOPOLOGY_H
+#define RT_TOPOLOGY_H
+
+#include <string>
+
+#include "affinity.h"
+
+// CPU topology of the local machine, as exported by the kernel under /sys
+// (every function degrades to a sensible default when the information is missing)
+
+namespace rt
+{
+
+// number of CPUs configured on the machine (possibly offline)
+size_t configured_cpus();
+
+// CPUs currently online
+cpu_set online_cpus();
+
+// CPUs isolated from the general scheduler (isolcpus= boot parameter)
+cpu_set isolated_cpus();
+
+// hardware threads sharing the core of "cpu" (including "cpu" itself)
+cpu_set core_siblings(size_t cpu);
+
+// NUMA node of "cpu" (0 on machines without NUMA information)
+int numa_node(size_t cpu);
+
+// CPUs belonging to NUMA node "node"
+cpu_set node_cpus(int node);
+
+// parses a kernel "cpulist" string, e.g. "0-3,8,10-11"
+cpu_set parse_cpu_list(const std::string & list);
+
+}
+
+#endif
+
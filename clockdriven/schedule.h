@@ -0,0 +1,141 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* Tabella di schedule piatta, contigua e di sola lettura, percorsa dall'executive a ogni frame.
+   Può essere generata a tempo di compilazione (StaticSchedule) oppure costruita da add_frame. */
+struct ScheduleTable {
+	unsigned int frame_length;      // lunghezza del frame (in quanti temporali)
+	size_t num_tasks;
+	size_t num_frames;
+	const unsigned int * wcet;      // [num_tasks] (nullptr: WCET presi da set_periodic_task)
+	const uint16_t * jobs;          // job di tutti i frame, nell'ordine di esecuzione
+	const uint32_t * frame_begin;   // [num_frames + 1]: job del frame f in [frame_begin[f], frame_begin[f+1])
+	const int * slack;              // [num_frames] slack del frame (in quanti temporali)
+	const long long * slack_prefix; // [num_frames + 1] slack cumulativo dei frame [0, f)
+};
+
+/* Elementi della definizione di uno schedule statico */
+template <unsigned int... W>
+struct Wcets {};
+
+template <uint16_t... Ids>
+struct Frame {
+	static constexpr size_t size = sizeof...(Ids);
+	static constexpr std::array<uint16_t, sizeof...(Ids)> ids{{Ids...}};
+};
+
+/* Schedule definito a tempo di compilazione, es.:
+
+	typedef StaticSchedule<4, Wcets<1, 2, 1>,
+	                       Frame<0, 1>,
+	                       Frame<0, 2>> Schedule;
+	exec.set_schedule(Schedule::table());
+
+   Id di task fuori range o ripetuti in un frame e frame con slack negativo (somma dei WCET >
+   frame_length) sono rifiutati da static_assert; le tabelle risiedono in memoria statica di sola lettura. */
+template <unsigned int FrameLength, typename WcetList, typename... Frames>
+struct StaticSchedule;
+
+namespace schedule_detail {
+
+// true se tutti gli id del frame F sono < NumTasks
+template <size_t NumTasks, typename F>
+constexpr bool ids_valid()
+{
+	for (size_t i = 0; i < F::size; ++i)
+		if (F::ids[i] >= NumTasks)
+			return false;
+	return true;
+}
+
+// true se nessun id compare due volte nel frame F (un task ha al più un job per frame)
+template <typename F>
+constexpr bool ids_distinct()
+{
+	for (size_t i = 0; i < F::size; ++i)
+		for (size_t k = i + 1; k < F::size; ++k)
+			if (F::ids[i] == F::ids[k])
+				return false;
+	return true;
+}
+
+// slack del frame F: FrameLength - somma dei WCET dei suoi job (gli id non validi non contano)
+template <unsigned int FrameLength, typename F, unsigned int... W>
+constexpr long long frame_slack()
+{
+	const unsigned int wcet[] = {W...};
+	long long s = FrameLength;
+	for (size_t i = 0; i < F::size; ++i)
+		s -= F::ids[i] < sizeof...(W) ? wcet[F::ids[i]] : 0;
+	return s;
+}
+
+template <typename... Frames>
+constexpr std::array<uint16_t, (Frames::size + ... + 0)> concat_jobs()
+{
+	std::array<uint16_t, (Frames::size + ... + 0)> out{};
+	size_t n = 0;
+	auto append = [&](const auto & ids) {
+		for (size_t i = 0; i < ids.size(); ++i)
+			out[n++] = ids[i];
+	};
+	(append(Frames::ids), ...);
+	return out;
+}
+
+template <typename... Frames>
+constexpr std::array<uint32_t, sizeof...(Frames) + 1> frame_begin()
+{
+	std::array<uint32_t, sizeof...(Frames) + 1> out{};
+	const size_t sizes[] = {Frames::size...};
+	for (size_t f = 0; f < sizeof...(Frames); ++f)
+		out[f + 1] = static_cast<uint32_t>(out[f] + sizes[f]);
+	return out;
+}
+
+template <size_t N>
+constexpr std::array<long long, N + 1> prefix_sums(const std::array<int, N> & slack)
+{
+	std::array<long long, N + 1> out{};
+	for (size_t f = 0; f < N; ++f)
+		out[f + 1] = out[f] + slack[f];
+	return out;
+}
+
+}
+
+template <unsigned int FrameLength, unsigned int... W, typename... Frames>
+struct StaticSchedule<FrameLength, Wcets<W...>, Frames...> {
+	static constexpr size_t num_tasks = sizeof...(W);
+	static constexpr size_t num_frames = sizeof...(Frames);
+	static constexpr size_t num_jobs = (Frames::size + ... + 0);
+
+	static_assert(FrameLength > 0, "frame length must be positive");
+	static_assert(num_tasks > 0, "at least one task is required");
+	static_assert(num_frames > 0, "at least one frame is required");
+	static_assert(num_tasks <= 0xFFFF, "task ids must fit in 16 bits");
+	static_assert((schedule_detail::ids_valid<num_tasks, Frames>() && ...),
+	              "frame references a task id out of range");
+	static_assert((schedule_detail::ids_distinct<Frames>() && ...),
+	              "frame references the same task id twice");
+	static_assert(((schedule_detail::frame_slack<FrameLength, Frames, W...>() >= 0) && ...),
+	              "frame overflow: the WCETs of a frame exceed the frame length");
+
+	static constexpr std::array<unsigned int, num_tasks> wcet{{W...}};
+	static constexpr std::array<uint16_t, num_jobs> jobs = schedule_detail::concat_jobs<Frames...>();
+	static constexpr std::array<uint32_t, num_frames + 1> frame_begin = schedule_detail::frame_begin<Frames...>();
+	static constexpr std::array<int, num_frames> slack{{static_cast<int>(schedule_detail::frame_slack<FrameLength, Frames, W...>())...}};
+	static constexpr std::array<long long, num_frames + 1> slack_prefix = schedule_detail::prefix_sums(slack);
+
+	static constexpr ScheduleTable table()
+	{
+		return ScheduleTable{FrameLength, num_tasks, num_frames, wcet.data(), jobs.data(),
+		                     frame_begin.data(), slack.data(), slack_prefix.data()};
+	}
+};
+
+#endif // SCHEDULE_H
@@ -0,0 +1,169 @@
+// Offline schedule synthesizer: reads a periodic task set and prints the frame table.
+// Input (a file or stdin): one task per line, "period wcet [deadline]" in time quanta;
+// blank lines and text after '#' are ignored. For example, the task set of application_1:
+//
+//   4 1
+//   5 2
+//   20 5
+//
+// gives 2-quantum frames with task 2 split in four parts (its hand-made 4-quantum frames
+// leave the second job of task 1 without a whole frame between release and deadline).
+//
+// Output: a readable listing (--format text, default) or C++ source defining the tables
+// and a ScheduleTable to pass to Executive::set_schedule (--format cpp).
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "synthesizer.h"
+
+static void usage(const char * name)
+{
+	std::cerr << "usage: " << name
+		<< " [--frame-length F] [--no-split] [--max-frames N] [--format text|cpp] [FILE]" << std::endl;
+}
+
+static bool read_tasks(std::istream & in, std::vector<PeriodicTaskSpec> & tasks)
+{
+	std::string line;
+	unsigned int n = 0;
+	while (std::getline(in, line))
+	{
+		++n;
+		line = line.substr(0, line.find('#'));
+		std::istringstream fields(line);
+		PeriodicTaskSpec t;
+		if (!(fields >> t.period))
+			continue;
+		if (!(fields >> t.wcet))
+		{
+			std::cerr << "line " << n << ": expected \"period wcet [deadline]\"" << std::endl;
+			return false;
+		}
+		fields >> t.deadline;
+		tasks.push_back(t);
+	}
+	return true;
+}
+
+static void print_text(std::ostream & out, const SynthesizedSchedule & s)
+{
+	out << "hyperperiod " << s.hyperperiod
+		<< ", frame length " << s.frame_length
+		<< ", frames " << s.num_frames()
+		<< ", preemptions " << s.preemptions
+		<< ", min slack " << s.min_slack << std::endl;
+
+	out << "slices (executive task id: task, part, wcet)" << std::endl;
+	for (size_t id = 0; id < s.slices.size(); ++id)
+		out << "  " << id << ": task " << s.slices[id].task
+			<< ", part " << s.slices[id].part
+			<< ", wcet " << s.slices[id].wcet << std::endl;
+
+	out << "frames (slice ids, slack)" << std::endl;
+	for (size_t k = 0; k < s.frames.size(); ++k)
+	{
+		out << "  " << k << ": {";
+		for (size_t i = 0; i < s.frames[k].size(); ++i)
+			out << (i ? "," : "") << s.frames[k][i];
+		out << "}  slack " << s.table_slack[k] << std::endl;
+	}
+}
+
+template <typename T>
+static void print_array(std::ostream & out, const char * type, const char * name, const std::vector<T> & v)
+{
+	out << "static const " << type << " " << name << "[] = {";
+	for (size_t i = 0; i < v.size(); ++i)
+		out << (i % 16 ? ", " : (i ? ",\n\t" : "\n\t")) << v[i];
+	out << "\n};\n";
+}
+
+static void print_cpp(std::ostream & out, const SynthesizedSchedule & s)
+{
+	out << "// generated by schedule_synth: hyperperiod " << s.hyperperiod
+		<< ", " << s.slices.size() << " slices, " << s.num_frames() << " frames"
+		<< ", " << s.preemptions << " preemptions, min slack " << s.min_slack << "\n";
+	out << "#include \"schedule.h\"\n\n";
+	out << "// slices (executive task id: task, part)\n";
+	for (size_t id = 0; id < s.slices.size(); ++id)
+		out << "//   " << id << ": task " << s.slices[id].task << ", part " << s.slices[id].part << "\n";
+	out << "\n";
+	print_array(out, "unsigned int", "schedule_wcet", s.table_wcet);
+	print_array(out, "uint16_t", "schedule_jobs", s.table_jobs);
+	print_array(out, "uint32_t", "schedule_frame_begin", s.table_frame_begin);
+	print_array(out, "int", "schedule_slack", s.table_slack);
+	print_array(out, "long long", "schedule_slack_prefix", s.table_slack_prefix);
+	out << "\nstatic const ScheduleTable schedule_table{" << s.frame_length << ", " << s.slices.size()
+		<< ", " << s.num_frames() << ",\n\tschedule_wcet, schedule_jobs, schedule_frame_begin,"
+		<< " schedule_slack, schedule_slack_prefix};\n";
+}
+
+int main(int argc, char * argv[])
+{
+	SynthesisOptions options;
+	std::string format = "text";
+	std::string file;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string a = argv[i];
+		if (a == "--no-split")
+			options.allow_split = false;
+		else if (a == "--frame-length" && i + 1 < argc)
+			options.frame_length = std::stoul(argv[++i]);
+		else if (a == "--max-frames" && i + 1 < argc)
+			options.max_frames = std::stoul(argv[++i]);
+		else if (a == "--format" && i + 1 < argc)
+			format = argv[++i];
+		else if (a.size() > 1 && a[0] == '-')
+		{
+			usage(argv[0]);
+			return 1;
+		}
+		else
+			file = a;
+	}
+	if (format != "text" && format != "cpp")
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::vector<PeriodicTaskSpec> tasks;
+	if (file.empty())
+	{
+		if (!read_tasks(std::cin, tasks))
+			return 1;
+	}
+	else
+	{
+		std::ifstream in(file);
+		if (!in)
+		{
+			std::cerr << "cannot open " << file << std::endl;
+			return 1;
+		}
+		if (!read_tasks(in, tasks))
+			return 1;
+	}
+
+	try
+	{
+		SynthesizedSchedule s = synthesize_schedule(tasks, options);
+		if (format == "cpp")
+			print_cpp(std::cout, s);
+		else
+			print_text(std::cout, s);
+	}
+	catch (synthesis_error & e)
+	{
+		std::cerr << "synthesis failed: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,428 @@
+// Simulated runs of the executive on a virtual clock (see simulator.h), used by "make test".
+// Each scenario runs thousands of hyperperiods of application_1's schedule with modelled
+// execution times and checks deadline misses, overrun policies, aperiodic service,
+// budget enforcement, mode changes and stop(); two small task sets compare the cyclic
+// schedule with rate monotonic and EDF. One short scenario runs the worker pool on the real
+// clock (the pool cannot be simulated), and is skipped without real-time priorities.
+// Exit status 0 if every check passes.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "executive.h"
+#include "rt/priority.h"
+#include "schedule.h"
+#include "simulator.h"
+#include "task_set.h"
+#include "trace.h"
+
+typedef std::chrono::nanoseconds ns;
+
+static const unsigned int HYPERPERIODS = 10000;
+static const unsigned int UNIT_MS = 10;
+static const unsigned int FRAME_LENGTH = 4;
+static const unsigned int NUM_FRAMES = 5;
+
+// jobs of each task per hyperperiod in application_1's frame table
+static const unsigned int JOBS_PER_HYPERPERIOD[] = {5, 4, 1, 1, 1};
+
+// degraded mode for the mode-change scenario: tasks 0 and 1 only, two frames per hyperperiod
+typedef StaticSchedule<FRAME_LENGTH,
+                       Wcets<1, 2, 1, 3, 1>,
+                       Frame<0, 1>,
+                       Frame<0>> DegradedSchedule;
+static const unsigned int DEGRADED_JOBS_PER_HYPERPERIOD[] = {2, 1, 0, 0, 0};
+
+static int failures = 0;
+
+static void check(bool ok, const char * scenario, const char * what)
+{
+	if (!ok)
+	{
+		++failures;
+		std::cout << "FAIL " << scenario << ": " << what << std::endl;
+	}
+}
+
+static void noop()
+{
+}
+
+static void setup(Executive & exec)
+{
+	exec.set_periodic_task(0, noop, 1);
+	exec.set_periodic_task(1, noop, 2);
+	exec.set_periodic_task(2, noop, 1);
+	exec.set_periodic_task(3, noop, 3);
+	exec.set_periodic_task(4, noop, 1);
+
+	exec.add_frame({0,1,2});
+	exec.add_frame({0,3});
+	exec.add_frame({0,1});
+	exec.add_frame({0,1});
+	exec.add_frame({0,1,4});
+}
+
+static ns quanta(double q)
+{
+	return ns(static_cast<long long>(q * UNIT_MS * 1000000.0));
+}
+
+static void report(const char * scenario, const Executive & exec, const Simulator & sim)
+{
+	Executive::Stats st = exec.stats();
+	const Simulator::Counters & c = sim.counters();
+	uint64_t misses = 0;
+	for (const auto & ts : st.tasks)
+		misses += ts.deadline_misses;
+
+	std::cout << scenario
+		<< ": frames " << st.frames
+		<< ", simulated " << std::chrono::duration_cast<std::chrono::seconds>(c.elapsed).count() << " s"
+		<< ", busy " << 100.0 * c.busy.count() / c.elapsed.count() << "%"
+		<< ", preemptions " << c.preemptions
+		<< ", deadline misses " << misses
+		<< ", ap served " << c.ap_completed << std::endl;
+}
+
+// every job takes exactly its WCET: the schedule must run without misses
+static void nominal()
+{
+	Executive exec(5, FRAME_LENGTH, UNIT_MS);
+	Simulator sim(exec);
+	setup(exec);
+	sim.run(HYPERPERIODS);
+
+	Executive::Stats st = exec.stats();
+	check(st.frames == HYPERPERIODS * NUM_FRAMES, "nominal", "frames run");
+	for (size_t tid = 0; tid < 5; ++tid)
+	{
+		check(st.tasks[tid].deadline_misses == 0, "nominal", "deadline miss");
+		check(sim.counters().jobs_completed[tid] == HYPERPERIODS * JOBS_PER_HYPERPERIOD[tid], "nominal", "jobs completed");
+		check(st.tasks[tid].response_time.max <= quanta(FRAME_LENGTH), "nominal", "response time beyond the frame");
+	}
+	report("nominal", exec, sim);
+}
+
+// task 3 (WCET 3, alone with task 0 in a full frame) overruns by one quantum every 10th job:
+// each overrun is one miss and the late job goes on in the next frame's slack, where it
+// finishes (Skip, Continue) or stops at its cancel token (Abort, Fallback). Skip then drops the
+// next release of task 3, Fallback runs the fallback function in its place; the other tasks are
+// not affected
+static void overrun(Executive::OverrunPolicy policy)
+{
+	static const char * names[] = {"overrun skip", "overrun continue", "overrun abort", "overrun fallback"};
+	const char * scenario = names[static_cast<int>(policy)];
+	Executive exec(5, FRAME_LENGTH, UNIT_MS);
+	Simulator sim(exec);
+	setup(exec);
+	exec.set_periodic_task(3, noop, 3, policy);
+	exec.set_fallback_task(3, noop, 1);
+
+	unsigned long long overruns = 0;
+	sim.set_exec_time(3, [&overruns](unsigned long long job) {
+		if (job % 10 == 9)
+		{
+			++overruns;
+			return quanta(4);
+		}
+		return quanta(3);
+	});
+	sim.run(HYPERPERIODS);
+
+	// the last overrun may fall in the last hyperperiod, with no release after it
+	Executive::Stats st = exec.stats();
+	const Executive::TaskStats & t3 = st.tasks[3];
+	const Simulator::Counters & c = sim.counters();
+	const bool skip = policy == Executive::OverrunPolicy::Skip;
+	const bool cancel = policy == Executive::OverrunPolicy::Abort || policy == Executive::OverrunPolicy::Fallback;
+	auto after_overrun = [overruns](uint64_t n) { return n == overruns || n + 1 == overruns; };
+	check(overruns > 0, scenario, "no overrun injected");
+	check(t3.deadline_misses == overruns, scenario, "one miss per overrun");
+	check(skip ? after_overrun(t3.skipped) : t3.skipped == 0, scenario, "skipped releases");
+	check(c.jobs_completed[3] + t3.skipped == HYPERPERIODS, scenario, "jobs completed (released)");
+	check(t3.cancelled == (cancel ? overruns : 0), scenario, "one cancel request per overrun");
+	check(policy == Executive::OverrunPolicy::Fallback ? after_overrun(t3.fallbacks) : t3.fallbacks == 0,
+	      scenario, "fallback jobs");
+	for (size_t tid = 0; tid < 5; ++tid)
+	{
+		if (tid == 3)
+			continue;
+		check(st.tasks[tid].deadline_misses == 0, scenario, "miss of a task that did not overrun");
+		check(c.jobs_completed[tid] == HYPERPERIODS * JOBS_PER_HYPERPERIOD[tid], scenario, "jobs completed");
+	}
+	report(scenario, exec, sim);
+}
+
+// two unit tasks in a frame of 2 quanta; the first one takes 2 quanta every 10th job.
+// Without budget enforcement it keeps the CPU until the end of the frame and the second job
+// misses its deadline; with enforcement it is demoted as soon as it exceeds its WCET, so the
+// second job runs on time and the overrunning job is the one that misses
+static void budget(bool enforce)
+{
+	const char * scenario = enforce ? "budget" : "no budget";
+	Executive exec(2, 2, UNIT_MS);
+	Simulator sim(exec);
+	exec.set_budget_enforcement(enforce);
+	exec.set_periodic_task(0, noop, 1);
+	exec.set_periodic_task(1, noop, 1);
+	exec.add_frame({0, 1});
+
+	unsigned long long overruns = 0;
+	sim.set_exec_time(0, [&overruns](unsigned long long job) {
+		if (job % 10 == 9)
+		{
+			++overruns;
+			return quanta(2);
+		}
+		return quanta(1);
+	});
+	sim.run(HYPERPERIODS);
+
+	Executive::Stats st = exec.stats();
+	check(overruns > 0, scenario, "no overrun injected");
+	check(st.tasks[0].deadline_misses == (enforce ? overruns : 0), scenario, "misses of the overrunning task");
+	check(st.tasks[0].budget_overruns == (enforce ? overruns : 0), scenario, "budget overruns");
+	check(st.tasks[1].deadline_misses == (enforce ? 0 : overruns), scenario, "misses of the task behind the overrun");
+	report(scenario, exec, sim);
+}
+
+// switch to the degraded mode and back in the middle of a hyperperiod, then stop mid-frame:
+// each switch takes effect at the next hyperperiod boundary, the stop at the end of the frame
+static void modes()
+{
+	Executive exec(5, FRAME_LENGTH, UNIT_MS);
+	Simulator sim(exec);
+	setup(exec);
+	const size_t degraded = exec.add_mode(DegradedSchedule::table());
+
+	sim.add_action(quanta(FRAME_LENGTH * 52.5), [&exec, degraded]() { exec.change_mode(degraded); });
+	sim.add_action(quanta(FRAME_LENGTH * 95.5), [&exec]() { exec.change_mode(0); });
+	sim.add_action(quanta(FRAME_LENGTH * 149.5), [&exec]() { exec.stop(); });
+	sim.run(HYPERPERIODS);
+
+	// frames 0-54: 11 hyperperiods of mode 0; 55-96: 21 of the degraded mode;
+	// 97-146: 10 of mode 0; 147-149: frames 0-2 of mode 0, then the stop
+	static const unsigned int PARTIAL_JOBS[] = {3, 2, 1, 1, 0};
+	Executive::Stats st = exec.stats();
+	check(st.frames == 150, "modes", "frames run before the stop");
+	check(exec.current_mode() == 0, "modes", "final mode");
+	for (size_t tid = 0; tid < 5; ++tid)
+	{
+		unsigned long long expected = 21 * JOBS_PER_HYPERPERIOD[tid] + 21 * DEGRADED_JOBS_PER_HYPERPERIOD[tid] + PARTIAL_JOBS[tid];
+		check(st.tasks[tid].deadline_misses == 0, "modes", "deadline miss");
+		check(sim.counters().jobs_completed[tid] == expected, "modes", "jobs completed");
+	}
+	report("modes", exec, sim);
+}
+
+// aperiodic requests at pseudo-random instants, served in the slack of frames 2 and 3
+static std::vector<uint64_t> aperiodic(bool print)
+{
+	Executive exec(5, FRAME_LENGTH, UNIT_MS);
+	Simulator sim(exec);
+	setup(exec);
+	exec.set_aperiodic_task(noop, 1);
+	exec.set_aperiodic_queue(256);
+
+	// one request every 2..6 frames, 0.5 quanta each (a quarter of the schedule's slack)
+	uint32_t lcg = 12345;
+	auto next_random = [&lcg]() { lcg = lcg * 1664525u + 1013904223u; return lcg >> 8; };
+	const ns hyperperiod = quanta(FRAME_LENGTH * NUM_FRAMES);
+	ns at(0);
+	unsigned long long requests = 0;
+	while (true)
+	{
+		at += quanta(FRAME_LENGTH) * 2 + quanta(FRAME_LENGTH * 4.0 * (next_random() % 1000) / 1000.0);
+		if (at >= hyperperiod * (HYPERPERIODS - 1))
+			break;
+		sim.add_ap_request(at);
+		++requests;
+	}
+	sim.set_ap_exec_time(0, [](unsigned long long) { return quanta(0.5); });
+	sim.run(HYPERPERIODS);
+
+	Executive::Stats st = exec.stats();
+	const Simulator::Counters & c = sim.counters();
+	if (print)
+	{
+		check(c.ap_completed == requests, "aperiodic", "requests not served");
+		check(exec.ap_counters().served == requests, "aperiodic", "served counter");
+		check(st.ap_response_time.max <= hyperperiod, "aperiodic", "response time beyond a hyperperiod");
+		for (size_t tid = 0; tid < 5; ++tid)
+		{
+			check(st.tasks[tid].deadline_misses == 0, "aperiodic", "deadline miss");
+			check(c.jobs_completed[tid] == HYPERPERIODS * JOBS_PER_HYPERPERIOD[tid], "aperiodic", "jobs completed");
+		}
+		report("aperiodic", exec, sim);
+		std::cout << "aperiodic: " << requests << " requests, response p50 "
+			<< st.ap_response_time.p50.count() / 1000000.0 << " ms, max "
+			<< st.ap_response_time.max.count() / 1000000.0 << " ms" << std::endl;
+	}
+
+	// fingerprint of the run, for the determinism check
+	std::vector<uint64_t> fingerprint(c.jobs_completed.begin(), c.jobs_completed.end());
+	fingerprint.push_back(c.ap_completed);
+	fingerprint.push_back(c.preemptions);
+	fingerprint.push_back(c.busy.count());
+	fingerprint.push_back(st.ap_response_time.p50.count());
+	fingerprint.push_back(st.ap_response_time.p99.count());
+	fingerprint.push_back(st.ap_response_time.max.count());
+	for (const auto & ts : st.tasks)
+	{
+		fingerprint.push_back(ts.response_time.p99.count());
+		fingerprint.push_back(ts.response_time.max.count());
+	}
+	return fingerprint;
+}
+
+// the same task set under every policy: {4,1},{8,2},{8,2} (U = 0.75) runs without misses in
+// the synthesized cyclic schedule, under RM and under EDF
+static void policies()
+{
+	static const char * names[] = {"cyclic", "rate monotonic", "edf"};
+	static const unsigned int jobs_per_hyperperiod[] = {2, 1, 1};
+
+	TaskSet set;
+	set.add_task(noop, {4, 1});
+	set.add_task(noop, {8, 2});
+	set.add_task(noop, {8, 2});
+
+	for (Executive::SchedPolicy policy : {Executive::SchedPolicy::Cyclic, Executive::SchedPolicy::RateMonotonic, Executive::SchedPolicy::Edf})
+	{
+		const char * scenario = names[static_cast<int>(policy)];
+		TaskSet::Plan plan = set.plan(policy);
+		Executive exec(set.size(), plan.frame_length, UNIT_MS);
+		Simulator sim(exec);
+		set.apply(exec, plan);
+		sim.run(HYPERPERIODS);
+
+		Executive::Stats st = exec.stats();
+		for (size_t tid = 0; tid < set.size(); ++tid)
+		{
+			check(st.tasks[tid].deadline_misses == 0, scenario, "deadline miss");
+			check(sim.counters().jobs_completed[tid] == HYPERPERIODS * jobs_per_hyperperiod[tid], scenario, "jobs completed");
+			check(st.tasks[tid].response_time.max <= quanta(set.spec(tid).deadline), scenario, "response time beyond the deadline");
+		}
+		report(scenario, exec, sim);
+	}
+}
+
+// {5,2},{7,4} (U = 0.97): feasible under EDF only. RM lets task 0 preempt task 1, which misses;
+// no cyclic schedule exists without splitting task 1's jobs
+static void edf_only()
+{
+	TaskSet set;
+	set.add_task(noop, {5, 2});
+	set.add_task(noop, {7, 4});
+
+	bool synthesized = true;
+	try
+	{
+		set.plan(Executive::SchedPolicy::Cyclic);
+	}
+	catch (const synthesis_error &)
+	{
+		synthesized = false;
+	}
+	check(!synthesized, "edf only", "cyclic schedule without splitting");
+
+	for (Executive::SchedPolicy policy : {Executive::SchedPolicy::RateMonotonic, Executive::SchedPolicy::Edf})
+	{
+		const bool edf = policy == Executive::SchedPolicy::Edf;
+		const char * scenario = edf ? "edf only (edf)" : "edf only (rm)";
+		TaskSet::Plan plan = set.plan(policy);
+		Executive exec(set.size(), plan.frame_length, UNIT_MS);
+		Simulator sim(exec);
+		set.apply(exec, plan);
+		sim.run(HYPERPERIODS / 10);
+
+		Executive::Stats st = exec.stats();
+		check(st.tasks[0].deadline_misses == 0, scenario, "deadline miss of task 0");
+		check((st.tasks[1].deadline_misses == 0) == edf, scenario, "deadline misses of task 1");
+		if (edf)
+			check(sim.counters().jobs_completed[1] == HYPERPERIODS / 10 * 5, scenario, "jobs completed");
+		report(scenario, exec, sim);
+	}
+}
+
+// real clock (the simulator runs neither the pool nor real threads): every 4th job of a task released
+// in every frame sleeps for 2.5 frames. Skip drops the release after the miss, and the following one
+// finds the job still running: it must be skipped too, instead of re-arming the running job (one thread
+// per task) or handing the task to a second worker while the first runs it (pool)
+static std::atomic<int> slow_running{0};
+static std::atomic<int> slow_overlaps{0};
+static std::atomic<unsigned int> slow_jobs{0};
+
+static void slow_job()
+{
+	if (slow_running.fetch_add(1) > 0)
+		slow_overlaps.fetch_add(1);
+	if (slow_jobs.fetch_add(1) % 4 == 0)
+		std::this_thread::sleep_for(std::chrono::microseconds(12500));
+	slow_running.fetch_sub(1);
+}
+
+static void long_overrun(Executive::ExecMode mode)
+{
+	const char * scenario = mode == Executive::ExecMode::Pool ? "pool overrun" : "threads overrun";
+	try
+	{
+		rt::this_thread::scoped_priority probe(rt::priority::rt_min);
+	}
+	catch (const rt::permission_error &)
+	{
+		std::cout << scenario << ": skipped (no real-time priorities)" << std::endl;
+		return;
+	}
+
+	slow_jobs = 0;
+	slow_overlaps = 0;
+	Executive exec(1, 1, std::chrono::milliseconds(5));
+	if (mode == Executive::ExecMode::Pool)
+		exec.set_execution_mode(mode, 2);
+	exec.set_periodic_task(0, slow_job, 1);
+	exec.add_frame({0});
+	exec.set_hyperperiod_limit(80);
+	exec.start();
+	exec.wait();
+
+	Executive::Stats st = exec.stats();
+	check(slow_overlaps.load() == 0, scenario, "two workers ran the same task at once");
+	check(st.tasks[0].deadline_misses > 0, scenario, "no deadline miss");
+	check(st.tasks[0].skipped > st.tasks[0].deadline_misses, scenario, "releases not skipped while the job runs");
+	std::cout << scenario << ": frames " << st.frames
+		<< ", jobs " << slow_jobs.load() << ", overlaps " << slow_overlaps.load()
+		<< ", deadline misses " << st.tasks[0].deadline_misses
+		<< ", skipped " << st.tasks[0].skipped << std::endl;
+}
+
+int main()
+{
+	Tracer::global().set_enabled(false);
+
+	auto start = std::chrono::steady_clock::now();
+
+	nominal();
+	overrun(Executive::OverrunPolicy::Skip);
+	overrun(Executive::OverrunPolicy::Continue);
+	overrun(Executive::OverrunPolicy::Abort);
+	overrun(Executive::OverrunPolicy::Fallback);
+	budget(false);
+	budget(true);
+	modes();
+	std::vector<uint64_t> first = aperiodic(true);
+	check(aperiodic(false) == first, "determinism", "two runs of the same scenario differ");
+	policies();
+	edf_only();
+	long_overrun(Executive::ExecMode::Threads);
+	long_overrun(Executive::ExecMode::Pool);
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << (failures ? "FAILED" : "OK") << " (" << seconds << " s wall clock)" << std::endl;
+	return failures ? 1 : 0;
+}
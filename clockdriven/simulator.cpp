@@ -0,0 +1,241 @@
+#include "simulator.h"
+#include "trace.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+uint64_t elapsed_ns(ExecClock::time_point from, ExecClock::time_point to) {
+    return to > from ? std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count() : 0;
+}
+
+}
+
+Simulator::Simulator(Executive & exec_)
+    : exec(exec_), threads(exec_.tasks.size() + 1), task_time(exec_.tasks.size()),
+      start_time(std::chrono::seconds(1)), t(start_time)
+{
+    count.jobs_completed.assign(exec.tasks.size(), 0);
+    count.ap_completed = 0;
+    count.preemptions = 0;
+    count.busy = std::chrono::nanoseconds(0);
+    count.elapsed = std::chrono::nanoseconds(0);
+    exec.set_clock(*this);
+}
+
+void Simulator::set_exec_time(size_t task_id, ExecTime model) {
+    assert(task_id < task_time.size());
+    task_time[task_id] = std::move(model);
+}
+
+void Simulator::set_ap_exec_time(size_t class_id, ExecTime model) {
+    if (ap_time.size() <= class_id)
+        ap_time.resize(class_id + 1);
+    ap_time[class_id] = std::move(model);
+}
+
+void Simulator::add_ap_request(std::chrono::nanoseconds at, size_t class_id, void * arg) {
+    assert(!done);
+    arrivals.push_back(Arrival{at, class_id, arg, nullptr});
+}
+
+void Simulator::add_action(std::chrono::nanoseconds at, std::function<void()> action) {
+    assert(!done && action);
+    arrivals.push_back(Arrival{at, 0, nullptr, std::move(action)});
+}
+
+void Simulator::run(unsigned long long hyperperiods) {
+    assert(!done && hyperperiods > 0);
+    done = true;
+
+    // modelli di default: ogni job dura esattamente il suo WCET
+    for (size_t tid = 0; tid < task_time.size(); ++tid)
+        if (!task_time[tid]) {
+            std::chrono::nanoseconds wcet = exec.task_config[tid].wcet * exec.unit_time;
+            task_time[tid] = [wcet](unsigned long long) { return wcet; };
+        }
+    ap_time.resize(exec.ap_classes.size());
+    for (size_t c = 0; c < ap_time.size(); ++c)
+        if (!ap_time[c]) {
+            std::chrono::nanoseconds wcet = exec.ap_classes[c].wcet * exec.unit_time;
+            ap_time[c] = [wcet](unsigned long long) { return wcet; };
+        }
+    std::stable_sort(arrivals.begin(), arrivals.end(), [](const Arrival& a, const Arrival& b) { return a.at < b.at; });
+
+    // il thread executive chiama l'orologio simulato: tutta la simulazione avviene in quel thread
+    exec.set_hyperperiod_limit(hyperperiods);
+    exec.start(start_time);
+    exec.wait();
+    count.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(t - start_time);
+}
+
+void Simulator::arm(time_point first, std::chrono::nanoseconds period_) {
+    next_boundary = first;
+    period = period_;
+}
+
+unsigned long long Simulator::wait_next() {
+    // l'executive non consuma tempo simulato: nessun confine viene mai perso
+    advance(next_boundary, nullptr, 0);
+    next_boundary += period;
+    return 0;
+}
+
+void Simulator::sleep_until(time_point abs_time) {
+    advance(abs_time, nullptr, 0);
+}
+
+bool Simulator::wait_until(std::atomic<int> & word, int expected, time_point abs_time) {
+    advance(abs_time, &word, expected);
+    return word.load(std::memory_order_acquire) != expected;
+}
+
+void Simulator::wake(std::atomic<int> & word) {
+    // il thread rilasciato va in coda ai thread di pari priorità
+    size_t i = ap_index();
+    if (&word != &exec.ap_T.state)
+        i = static_cast<size_t>(reinterpret_cast<const Executive::TaskData*>(&word) - exec.tasks.data());
+    threads[i].seq = ++seq_counter;
+}
+
+void Simulator::set_priority(std::thread &, uint16_t id, const rt::priority & p) {
+    VThread& V = threads[id == TRACE_NO_TASK ? ap_index() : id];
+    V.priority = p;
+    V.seq = ++seq_counter;
+}
+
+int Simulator::pick() const {
+    // thread pronto di priorità massima (a pari priorità il primo arrivato)
+    int best = -1;
+    for (size_t i = 0; i < threads.size(); ++i) {
+        const auto& state = (i == ap_index()) ? exec.ap_T.state : exec.tasks[i].state;
+        if (state.load(std::memory_order_relaxed) == static_cast<int>(Executive::State::Idle))
+            continue;
+        if (best < 0 || threads[i].priority > threads[best].priority
+            || (threads[i].priority == threads[best].priority && threads[i].seq < threads[best].seq))
+            best = static_cast<int>(i);
+    }
+    return best;
+}
+
+bool Simulator::begin(size_t i) {
+    // inizio di un job (come wait_release) o della prossima richiesta aperiodica
+    VThread& V = threads[i];
+    if (i == ap_index()) {
+        exec.ap_T.state.store(static_cast<int>(Executive::State::Running), std::memory_order_release);
+        if (!exec.ap_next(ap_job)) {
+            Executive::job_done(exec.ap_T);
+            return false;
+        }
+        V.length = ap_time[ap_job.class_id](V.jobs++);
+    } else {
+        Executive::TaskData& T = exec.tasks[i];
+        T.state.store(static_cast<int>(Executive::State::Running), std::memory_order_release);
+        V.tag = T.job_tag;
+        Tracer::global().emit(TraceEvent::JobStart, T.trace_id, exec.abs_frame.load(std::memory_order_relaxed));
+        // la funzione di riserva dura il suo WCET e non conta tra i job del modello
+        const Executive::TaskConfig& cfg = exec.task_config[i];
+        V.length = T.fallback ? cfg.fallback_wcet * exec.unit_time : task_time[i](V.jobs++);
+        const unsigned int wcet = T.fallback ? cfg.fallback_wcet : cfg.wcet;
+        if (exec.budget_enforcement && wcet > 0)
+            V.budget = wcet * exec.unit_time;
+    }
+    V.busy = true;
+    V.over_budget = false;
+    V.remaining = V.length;
+    V.start = t;
+    return true;
+}
+
+void Simulator::finish(size_t i) {
+    VThread& V = threads[i];
+    V.busy = false;
+    V.budget = std::chrono::nanoseconds::max();
+    if (i == ap_index()) {
+        exec.ap_finish(ap_job);
+        ++count.ap_completed;
+        return;
+    }
+
+    // stesse misure di Executive::run_job, sui tempi virtuali
+    Executive::TaskData& T = exec.tasks[i];
+    Executive::TaskMeasures& M = exec.task_measures[i];
+    Tracer::global().emit(TraceEvent::JobEnd, T.trace_id, exec.abs_frame.load(std::memory_order_relaxed));
+    M.latency_hist.record(elapsed_ns(T.release_stamp, V.start));
+    M.jitter_hist.record(elapsed_ns(T.release_time, V.start));
+    M.response_hist.record(elapsed_ns(T.release_time, t));
+    M.exec_hist.record((V.length - V.remaining).count());
+    ++count.jobs_completed[i];
+    if (V.over_budget) {
+        M.budget_overruns.fetch_add(1, std::memory_order_relaxed);
+        Tracer::global().emit(TraceEvent::BudgetOverrun, T.trace_id, exec.abs_frame.load(std::memory_order_relaxed));
+    }
+
+    Executive::job_done(T);
+    exec.job_completed(V.tag);
+}
+
+bool Simulator::cancelled(size_t i) const {
+    // stesso esito di Executive::CancelToken::cancelled() nel job del task
+    if (i == ap_index())
+        return false;
+    const Executive::TaskData& T = exec.tasks[i];
+    const Executive::OverrunPolicy policy = exec.task_config[i].policy;
+    return T.cancel.load(std::memory_order_acquire)
+        || ((policy == Executive::OverrunPolicy::Abort || policy == Executive::OverrunPolicy::Fallback)
+            && T.over_budget.load(std::memory_order_acquire));
+}
+
+void Simulator::advance(time_point until, std::atomic<int> * word, int expected) {
+    // fa girare la CPU simulata fino a "until" (o finché word cambia), un evento alla volta
+    while (true) {
+        for (; next_arrival < arrivals.size() && start_time + arrivals[next_arrival].at <= t; ++next_arrival) {
+            const Arrival& a = arrivals[next_arrival];
+            if (a.action)
+                a.action();
+            else
+                exec.ap_task_request(a.class_id, a.arg);
+        }
+        if (word && word->load(std::memory_order_acquire) != expected)
+            return;
+        if (t >= until)
+            return;
+
+        time_point limit = until;
+        if (next_arrival < arrivals.size())
+            limit = std::min(limit, start_time + arrivals[next_arrival].at);
+
+        int i = pick();
+        if (i < 0) {
+            t = limit;
+            continue;
+        }
+        if (!threads[i].busy && !begin(i))
+            continue;
+        if (cancelled(i)) {
+            // il job controlla il CancelToken appena torna in esecuzione e termina subito
+            finish(i);
+            continue;
+        }
+        if (last_run >= 0 && last_run != i && threads[last_run].busy)
+            ++count.preemptions;
+        last_run = i;
+
+        VThread& V = threads[i];
+        auto d = std::min({V.remaining, V.budget, std::chrono::duration_cast<std::chrono::nanoseconds>(limit - t)});
+        t += d;
+        V.remaining -= d;
+        V.budget -= d;
+        count.busy += d;
+        if (V.remaining == std::chrono::nanoseconds(0)) {
+            finish(i);
+        } else if (V.budget == std::chrono::nanoseconds(0)) {
+            // budget esaurito: come il gestore di rt::cpu_budget, il thread si abbassa subito
+            V.budget = std::chrono::nanoseconds::max();
+            V.over_budget = true;
+            V.priority = rt::priority::rt_min + 1;
+            V.seq = ++seq_counter;
+            exec.tasks[i].over_budget.store(true, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include "executive.h"
+
+/* Simulatore a eventi discreti con orologio virtuale: esegue la stessa logica di exec_function
+   (rilasci, piano di priorità, skip_count, verifica delle deadline, server aperiodico e recupero
+   dello slack) su una CPU simulata con scheduling a priorità fissa preemptive (SCHED_FIFO),
+   con tempi di esecuzione modellati (e il budget dei job, vedi Executive::set_budget_enforcement).
+   Un job a cui l'executive chiede l'annullamento (OverrunPolicy::Abort, Fallback) termina appena
+   torna in esecuzione, come se controllasse il CancelToken.
+   Le funzioni dei task non vengono eseguite e il tempo dell'executive è nullo: migliaia di
+   iperperiodi si verificano in pochi secondi, in modo deterministico. Es.:
+
+	Executive exec(5, 4, 10);
+	Simulator sim(exec);               // prima di set_periodic_task
+	exec.set_periodic_task(0, task0, 1);
+	...
+	sim.set_exec_time(3, [](unsigned long long job) { ... });
+	sim.run(10000);
+	Executive::Stats st = exec.stats();
+*/
+class Simulator : public ExecClock {
+public:
+	// Tempo di esecuzione del job di indice "job" (0, 1, ... in ordine di inizio) di un task
+	typedef std::function<std::chrono::nanoseconds(unsigned long long job)> ExecTime;
+
+	struct Counters {
+		std::vector<unsigned long long> jobs_completed;  // per task_id
+		unsigned long long ap_completed;                 // richieste aperiodiche servite
+		unsigned long long preemptions;                  // job sospesi per un thread di priorità maggiore
+		std::chrono::nanoseconds busy;                   // tempo simulato occupato dai job
+		std::chrono::nanoseconds elapsed;                // tempo simulato totale
+	};
+
+	/* [INIT] Collega il simulatore all'executive (da invocare prima di set_periodic_task) */
+	explicit Simulator(Executive & exec);
+
+	/* [INIT] Tempo di esecuzione dei job del task "task_id" (default: il WCET) */
+	void set_exec_time(size_t task_id, ExecTime model);
+
+	/* [INIT] Tempo di esecuzione delle richieste della classe aperiodica "class_id" (default: il WCET) */
+	void set_ap_exec_time(size_t class_id, ExecTime model);
+
+	/* [INIT] Richiesta aperiodica all'istante "at" dall'inizio della simulazione:
+		class_id, arg: come in Executive::ap_task_request.
+	*/
+	void add_ap_request(std::chrono::nanoseconds at, size_t class_id = 0, void * arg = nullptr);
+
+	/* [INIT] Azione eseguita all'istante "at" dall'inizio della simulazione, nel thread executive
+		(es. Executive::change_mode o Executive::stop):
+		action: funzione da eseguire.
+	*/
+	void add_action(std::chrono::nanoseconds at, std::function<void()> action);
+
+	/* [RUN] Simula il numero di iperperiodi indicato (una sola volta per simulatore) */
+	void run(unsigned long long hyperperiods);
+
+	/* [RUN] Contatori della simulazione (le misure dei job sono in Executive::stats()) */
+	const Counters & counters() const { return count; }
+
+	/* Istante virtuale di inizio della simulazione */
+	time_point origin() const { return start_time; }
+
+	time_point now() override { return t; }
+	void arm(time_point first, std::chrono::nanoseconds period) override;
+	unsigned long long wait_next() override;
+	void sleep_until(time_point abs_time) override;
+	bool wait_until(std::atomic<int> & word, int expected, time_point abs_time) override;
+	void wake(std::atomic<int> & word) override;
+	void set_priority(std::thread & thread, uint16_t id, const rt::priority & p) override;
+
+private:
+	// thread simulato: un task periodico o (ultimo) il server aperiodico
+	struct VThread {
+		rt::priority priority{rt::priority::rt_min};
+		unsigned long long seq{0};            // ordine FIFO tra thread di pari priorità
+		bool busy{false};                     // job (o richiesta aperiodica) in corso
+		std::chrono::nanoseconds remaining{0};
+		std::chrono::nanoseconds length{0};
+		std::chrono::nanoseconds budget{std::chrono::nanoseconds::max()};  // budget di CPU rimanente del job
+		bool over_budget{false};
+		time_point start;
+		unsigned long long jobs{0};           // job iniziati
+		unsigned int tag{0};                  // frame del job in corso (Executive::TaskData::job_tag all'inizio)
+	};
+
+	// richiesta aperiodica, oppure azione se action è impostata
+	struct Arrival {
+		std::chrono::nanoseconds at;
+		size_t class_id;
+		void * arg;
+		std::function<void()> action;
+	};
+
+	Executive & exec;
+	std::vector<VThread> threads;
+	std::vector<ExecTime> task_time;
+	std::vector<ExecTime> ap_time;
+	std::vector<Arrival> arrivals;
+	size_t next_arrival{0};
+	Executive::ApJob ap_job;
+
+	const time_point start_time;
+	time_point t;
+	time_point next_boundary;
+	std::chrono::nanoseconds period{0};
+	unsigned long long seq_counter{0};
+	int last_run{-1};
+	bool done{false};
+	Counters count;
+
+	void advance(time_point until, std::atomic<int> * word, int expected);
+	int pick() const;
+	bool begin(size_t i);
+	bool cancelled(size_t i) const;
+	void finish(size_t i);
+	size_t ap_index() const { return threads.size() - 1; }
+};
+
+#endif // SIMULATOR_H
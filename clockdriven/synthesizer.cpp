@@ -0,0 +1,460 @@
+#include "synthesizer.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+namespace {
+
+// job dell'iperperiodo, con la finestra di frame in cui può essere eseguito
+struct Job {
+    size_t task;
+    unsigned int wcet;
+    unsigned int first;               // primo frame che inizia dopo il rilascio
+    unsigned int last;                // ultimo frame che finisce entro la deadline
+    unsigned long long deadline;      // deadline assoluta (ordina i job nel frame)
+};
+
+struct Piece {
+    size_t job;
+    unsigned int frame;
+    unsigned int amount;
+};
+
+// esito della sintesi con una lunghezza di frame
+struct Attempt {
+    unsigned int frame_length = 0;
+    unsigned int preemptions = 0;
+    int min_slack = 0;
+    std::vector<Job> jobs;
+    std::vector<Piece> pieces;
+    std::vector<std::vector<size_t>> job_pieces;    // parti di ciascun job, in ordine di frame
+    std::vector<std::vector<size_t>> frame_pieces;  // parti assegnate a ciascun frame
+    std::vector<unsigned int> load;
+};
+
+unsigned long long hyperperiod_of(const std::vector<PeriodicTaskSpec> & tasks) {
+    unsigned long long h = 1;
+    for (auto& t : tasks) {
+        unsigned long long g = std::gcd(h, static_cast<unsigned long long>(t.period));
+        if (h / g > (1ull << 52) / t.period)
+            throw synthesis_error("hyperperiod too large");
+        h = h / g * t.period;
+    }
+    return h;
+}
+
+// divisori dell'iperperiodo in [lo, hi], in ordine decrescente
+std::vector<unsigned int> frame_candidates(unsigned long long h, unsigned long long lo, unsigned long long hi) {
+    std::vector<unsigned int> out;
+    if (lo > hi)
+        return out;
+    unsigned long long root = 1;
+    while ((root + 1) * (root + 1) <= h)
+        ++root;
+    if (hi - lo < root) {
+        for (unsigned long long f = lo; f <= hi; ++f)
+            if (h % f == 0)
+                out.push_back(static_cast<unsigned int>(f));
+    } else {
+        for (unsigned long long d = 1; d <= root; ++d) {
+            if (h % d != 0)
+                continue;
+            if (d >= lo && d <= hi)
+                out.push_back(static_cast<unsigned int>(d));
+            unsigned long long e = h / d;
+            if (e != d && e >= lo && e <= hi)
+                out.push_back(static_cast<unsigned int>(e));
+        }
+    }
+    std::sort(out.begin(), out.end(), std::greater<unsigned int>());
+    return out;
+}
+
+// finestre dei job dell'iperperiodo; false se un job non ha nessun frame intero tra rilascio e deadline
+bool build_jobs(const std::vector<PeriodicTaskSpec> & tasks, unsigned long long h, unsigned int f, std::vector<Job> & jobs) {
+    jobs.clear();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const auto& t = tasks[i];
+        for (unsigned long long r = 0; r < h; r += t.period) {
+            unsigned long long d = r + t.deadline;
+            unsigned long long first = (r + f - 1) / f;
+            unsigned long long end = d / f;
+            if (end <= first)
+                return false;
+            jobs.push_back(Job{i, t.wcet, static_cast<unsigned int>(first), static_cast<unsigned int>(end - 1), d});
+        }
+    }
+    return true;
+}
+
+void add_piece(Attempt & a, size_t j, unsigned int frame, unsigned int amount) {
+    a.job_pieces[j].push_back(a.pieces.size());
+    a.frame_pieces[frame].push_back(a.pieces.size());
+    a.pieces.push_back(Piece{j, frame, amount});
+    a.load[frame] += amount;
+}
+
+void unlink_piece(Attempt & a, size_t p) {
+    auto& in_frame = a.frame_pieces[a.pieces[p].frame];
+    in_frame.erase(std::find(in_frame.begin(), in_frame.end(), p));
+    a.load[a.pieces[p].frame] -= a.pieces[p].amount;
+}
+
+void link_piece(Attempt & a, size_t p, unsigned int frame) {
+    a.pieces[p].frame = frame;
+    a.frame_pieces[frame].push_back(p);
+    a.load[frame] += a.pieces[p].amount;
+}
+
+void move_piece(Attempt & a, size_t p, unsigned int frame) {
+    unlink_piece(a, p);
+    link_piece(a, p, frame);
+}
+
+// frame in cui può stare la parte i del job j: la sua finestra, tra le parti adiacenti
+void piece_range(const Attempt & a, size_t j, size_t i, unsigned int & lo, unsigned int & hi) {
+    const auto& own = a.job_pieces[j];
+    lo = i > 0 ? a.pieces[own[i - 1]].frame + 1 : a.jobs[j].first;
+    hi = i + 1 < own.size() ? a.pieces[own[i + 1]].frame - 1 : a.jobs[j].last;
+}
+
+/* Assegnazione EDF a livello di frame: a ogni frame i job rilasciati vengono presi in ordine di
+   ultimo frame utile. Senza divisione un job che non entra resta in attesa (e si prova il
+   successivo); con divisione il frame viene riempito con una parte del job (EDF preemptive
+   a granularità di frame, ottimo per la fattibilità). */
+bool edf_assign(Attempt & a, size_t num_frames, bool split) {
+    const auto& jobs = a.jobs;
+    std::vector<size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return jobs[x].first < jobs[y].first; });
+
+    typedef std::pair<unsigned int, size_t> Key;  // (ultimo frame utile, job)
+    std::priority_queue<Key, std::vector<Key>, std::greater<Key>> ready;
+    std::vector<unsigned int> remaining(jobs.size());
+    std::vector<size_t> deferred;
+    size_t next = 0;
+
+    for (unsigned int k = 0; k < num_frames; ++k) {
+        for (; next < order.size() && jobs[order[next]].first == k; ++next) {
+            ready.push(Key(jobs[order[next]].last, order[next]));
+            remaining[order[next]] = jobs[order[next]].wcet;
+        }
+
+        unsigned int cap = a.frame_length;
+        deferred.clear();
+        while (!ready.empty() && cap > 0) {
+            size_t j = ready.top().second;
+            ready.pop();
+            if (remaining[j] <= cap) {
+                add_piece(a, j, k, remaining[j]);
+                cap -= remaining[j];
+            } else if (split) {
+                add_piece(a, j, k, cap);
+                remaining[j] -= cap;
+                cap = 0;
+                deferred.push_back(j);
+            } else {
+                deferred.push_back(j);
+            }
+        }
+        for (size_t j : deferred)
+            ready.push(Key(jobs[j].last, j));
+        if (!ready.empty() && ready.top().first <= k)
+            return false;
+    }
+    return ready.empty() && next == order.size();
+}
+
+// riunisce in un solo frame della finestra i job divisi da EDF che vi possono stare interi
+void merge_pieces(Attempt & a) {
+    for (size_t j = 0; j < a.jobs.size(); ++j) {
+        auto& own = a.job_pieces[j];
+        if (own.size() < 2)
+            continue;
+        const Job& J = a.jobs[j];
+        unsigned int best = J.last + 1;
+        unsigned int best_load = 0;
+        for (unsigned int t = J.first; t <= J.last; ++t) {
+            unsigned int mine = 0;
+            for (size_t p : own)
+                if (a.pieces[p].frame == t)
+                    mine = a.pieces[p].amount;
+            unsigned int l = a.load[t] - mine + J.wcet;
+            if (l <= a.frame_length && (best > J.last || l < best_load)) {
+                best = t;
+                best_load = l;
+            }
+        }
+        if (best > J.last)
+            continue;
+        size_t keep = own[0];
+        for (size_t p : own)
+            unlink_piece(a, p);
+        for (size_t p = 1; p < own.size(); ++p)
+            a.pieces[own[p]].amount = 0;
+        own.assign(1, keep);
+        a.pieces[keep].amount = J.wcet;
+        link_piece(a, keep, best);
+    }
+}
+
+/* Libera almeno "need" quanti nel frame t spostando altrove (nel loro intervallo consentito)
+   parti di job diversi da "skip"; le mosse fatte sono registrate in "moves" per poterle annullare */
+bool make_room(Attempt & a, unsigned int t, unsigned int need, size_t skip,
+               std::vector<std::pair<size_t, unsigned int>> & moves) {
+    std::vector<size_t> candidates = a.frame_pieces[t];
+    std::sort(candidates.begin(), candidates.end(),
+              [&](size_t x, size_t y) { return a.pieces[x].amount > a.pieces[y].amount; });
+    unsigned int freed = a.frame_length - std::min(a.load[t], a.frame_length);
+    for (size_t p : candidates) {
+        if (freed >= need)
+            break;
+        const size_t j = a.pieces[p].job;
+        if (j == skip)
+            continue;
+        const auto& own = a.job_pieces[j];
+        const size_t i = std::find(own.begin(), own.end(), p) - own.begin();
+        unsigned int lo, hi;
+        piece_range(a, j, i, lo, hi);
+        unsigned int target = t;
+        for (unsigned int u = lo; u <= hi; ++u)
+            if (u != t && a.load[u] + a.pieces[p].amount <= a.frame_length
+                && (target == t || a.load[u] < a.load[target]))
+                target = u;
+        if (target == t)
+            continue;
+        moves.push_back(std::make_pair(p, t));
+        move_piece(a, p, target);
+        freed += a.pieces[p].amount;
+    }
+    return freed >= need;
+}
+
+/* Riduce le preemption fondendo coppie di parti adiacenti dello stesso job nel frame di una
+   delle due, facendo spazio con make_room; se non c'è spazio le mosse vengono annullate */
+void fuse_pieces(Attempt & a) {
+    std::vector<std::pair<size_t, unsigned int>> moves;
+    for (size_t j = 0; j < a.jobs.size(); ++j) {
+        auto& own = a.job_pieces[j];
+        size_t i = 0;
+        while (i + 1 < own.size()) {
+            bool fused = false;
+            for (int side = 0; side < 2 && !fused; ++side) {
+                const size_t keep = own[i + side];
+                const size_t drop = own[i + 1 - side];
+                const unsigned int t = a.pieces[keep].frame;
+                const unsigned int amount = a.pieces[drop].amount;
+
+                unlink_piece(a, drop);
+                moves.clear();
+                if (make_room(a, t, amount, j, moves)) {
+                    a.pieces[drop].amount = 0;
+                    own.erase(own.begin() + i + 1 - side);
+                    a.load[t] += amount;
+                    a.pieces[keep].amount += amount;
+                    fused = true;
+                } else {
+                    for (auto m = moves.rbegin(); m != moves.rend(); ++m)
+                        move_piece(a, m->first, m->second);
+                    link_piece(a, drop, a.pieces[drop].frame);
+                }
+            }
+            if (!fused)
+                ++i;
+        }
+    }
+}
+
+/* Livellamento del carico: sposta ogni parte nel frame meno carico tra quelli consentiti (nella
+   finestra del job e tra le parti adiacenti dello stesso job), se così il frame di partenza si
+   scarica senza che la destinazione diventi altrettanto carica. Ogni mossa riduce la somma dei
+   quadrati dei carichi, quindi il procedimento termina; lo slack minimo non può peggiorare. */
+void level_load(Attempt & a) {
+    const int max_passes = 32;
+    for (int pass = 0; pass < max_passes; ++pass) {
+        bool moved = false;
+        for (size_t j = 0; j < a.jobs.size(); ++j) {
+            auto& own = a.job_pieces[j];
+            for (size_t i = 0; i < own.size(); ++i) {
+                const size_t p = own[i];
+                unsigned int lo, hi;
+                piece_range(a, j, i, lo, hi);
+                unsigned int target = a.pieces[p].frame;
+                for (unsigned int t = lo; t <= hi; ++t)
+                    if (a.load[t] < a.load[target])
+                        target = t;
+                if (target != a.pieces[p].frame && a.load[target] + a.pieces[p].amount < a.load[a.pieces[p].frame]) {
+                    move_piece(a, p, target);
+                    moved = true;
+                }
+            }
+        }
+        if (!moved)
+            break;
+    }
+}
+
+bool try_frame_length(const std::vector<PeriodicTaskSpec> & tasks, unsigned long long h, unsigned int f,
+                      bool split, Attempt & a) {
+    a = Attempt();
+    a.frame_length = f;
+    if (!build_jobs(tasks, h, f, a.jobs))
+        return false;
+    const size_t num_frames = static_cast<size_t>(h / f);
+
+    // prima senza dividere i job; la divisione solo se serve
+    bool ok = false;
+    for (bool s : {false, true}) {
+        if (s && !split)
+            break;
+        if (!s && std::any_of(a.jobs.begin(), a.jobs.end(), [f](const Job& J) { return J.wcet > f; }))
+            continue;
+        a.pieces.clear();
+        a.job_pieces.assign(a.jobs.size(), std::vector<size_t>());
+        a.frame_pieces.assign(num_frames, std::vector<size_t>());
+        a.load.assign(num_frames, 0);
+        if (edf_assign(a, num_frames, s)) {
+            ok = true;
+            if (s) {
+                merge_pieces(a);
+                fuse_pieces(a);
+            }
+            break;
+        }
+    }
+    if (!ok)
+        return false;
+
+    level_load(a);
+
+    a.preemptions = 0;
+    for (auto& own : a.job_pieces)
+        a.preemptions += static_cast<unsigned int>(own.size() - 1);
+    unsigned int max_load = *std::max_element(a.load.begin(), a.load.end());
+    a.min_slack = static_cast<int>(f) - static_cast<int>(max_load);
+    return true;
+}
+
+// true se l'esito a è preferibile a b: meno preemption, poi più slack minimo, poi frame più lunghi
+bool better(const Attempt & a, const Attempt & b) {
+    return std::make_tuple(b.preemptions, a.min_slack, a.frame_length)
+         > std::make_tuple(a.preemptions, b.min_slack, b.frame_length);
+}
+
+}
+
+ScheduleTable SynthesizedSchedule::table() const {
+    return ScheduleTable{frame_length, slices.size(), frames.size(), table_wcet.data(), table_jobs.data(),
+                         table_frame_begin.data(), table_slack.data(), table_slack_prefix.data()};
+}
+
+SynthesizedSchedule synthesize_schedule(const std::vector<PeriodicTaskSpec> & tasks_in,
+                                        const SynthesisOptions & options) {
+    if (tasks_in.empty())
+        throw synthesis_error("empty task set");
+
+    std::vector<PeriodicTaskSpec> tasks = tasks_in;
+    unsigned long long min_deadline = ~0ull;
+    for (auto& t : tasks) {
+        if (t.deadline == 0)
+            t.deadline = t.period;
+        if (t.period == 0 || t.wcet == 0)
+            throw synthesis_error("period and wcet must be positive");
+        if (t.deadline > t.period)
+            throw synthesis_error("deadline greater than period");
+        if (t.wcet > t.deadline)
+            throw synthesis_error("wcet greater than deadline");
+        min_deadline = std::min(min_deadline, static_cast<unsigned long long>(t.deadline));
+    }
+
+    const unsigned long long h = hyperperiod_of(tasks);
+    unsigned long long utilization = 0;
+    for (auto& t : tasks)
+        utilization += h / t.period * t.wcet;
+    if (utilization > h)
+        throw synthesis_error("utilization greater than 1");
+
+    // frame lunghi al più quanto la deadline più corta, e non più di max_frames frame per iperperiodo
+    std::vector<unsigned int> candidates;
+    if (options.frame_length) {
+        if (h % options.frame_length != 0)
+            throw synthesis_error("frame length does not divide the hyperperiod");
+        candidates.push_back(options.frame_length);
+    } else {
+        unsigned long long lo = std::max(1ull, (h + options.max_frames - 1) / std::max<size_t>(options.max_frames, 1));
+        candidates = frame_candidates(h, lo, min_deadline);
+    }
+
+    Attempt best, current;
+    bool found = false;
+    for (unsigned int f : candidates) {
+        // frame più corti non possono avere più slack: senza preemption lo schedule trovato è il migliore
+        if (found && best.preemptions == 0 && best.min_slack >= static_cast<int>(f))
+            break;
+        if (try_frame_length(tasks, h, f, options.allow_split, current) && (!found || better(current, best))) {
+            std::swap(best, current);
+            found = true;
+        }
+    }
+    if (!found)
+        throw synthesis_error("no feasible frame length");
+
+    SynthesizedSchedule out;
+    out.hyperperiod = h;
+    out.frame_length = best.frame_length;
+    out.preemptions = best.preemptions;
+    out.min_slack = best.min_slack;
+
+    // una slice (task dell'Executive) per ogni terna distinta (task, parte, WCET)
+    std::vector<std::pair<size_t, unsigned int>> piece_part(best.pieces.size());
+    std::map<std::tuple<size_t, unsigned int, unsigned int>, size_t> ids;
+    for (size_t j = 0; j < best.jobs.size(); ++j) {
+        auto& own = best.job_pieces[j];
+        std::sort(own.begin(), own.end(), [&](size_t x, size_t y) { return best.pieces[x].frame < best.pieces[y].frame; });
+        for (size_t i = 0; i < own.size(); ++i)
+            ids.emplace(std::make_tuple(best.jobs[j].task, static_cast<unsigned int>(i), best.pieces[own[i]].amount), 0);
+    }
+    if (ids.size() > 0xFFFF)
+        throw synthesis_error("too many slices for 16-bit task ids");
+    for (auto& e : ids) {
+        e.second = out.slices.size();
+        out.slices.push_back(SynthesizedSchedule::Slice{std::get<0>(e.first), std::get<1>(e.first), std::get<2>(e.first)});
+    }
+
+    // contenuto dei frame: parti in ordine di deadline assoluta (priorità decrescente nell'executive)
+    struct Entry { unsigned long long deadline; size_t slice; };
+    std::vector<std::vector<Entry>> frames(best.load.size());
+    for (size_t j = 0; j < best.jobs.size(); ++j) {
+        const auto& own = best.job_pieces[j];
+        for (size_t i = 0; i < own.size(); ++i) {
+            const Piece& P = best.pieces[own[i]];
+            size_t id = ids[std::make_tuple(best.jobs[j].task, static_cast<unsigned int>(i), P.amount)];
+            frames[P.frame].push_back(Entry{best.jobs[j].deadline, id});
+        }
+    }
+
+    out.table_wcet.reserve(out.slices.size());
+    for (auto& s : out.slices)
+        out.table_wcet.push_back(s.wcet);
+    out.frames.resize(frames.size());
+    out.table_frame_begin.push_back(0);
+    out.table_slack_prefix.push_back(0);
+    for (size_t k = 0; k < frames.size(); ++k) {
+        std::stable_sort(frames[k].begin(), frames[k].end(), [](const Entry& x, const Entry& y) {
+            return x.deadline < y.deadline || (x.deadline == y.deadline && x.slice < y.slice);
+        });
+        for (auto& e : frames[k]) {
+            out.frames[k].push_back(e.slice);
+            out.table_jobs.push_back(static_cast<uint16_t>(e.slice));
+        }
+        out.table_frame_begin.push_back(static_cast<uint32_t>(out.table_jobs.size()));
+        int slack = static_cast<int>(best.frame_length) - static_cast<int>(best.load[k]);
+        out.table_slack.push_back(slack);
+        out.table_slack_prefix.push_back(out.table_slack_prefix.back() + std::max(slack, 0));
+    }
+    return out;
+}
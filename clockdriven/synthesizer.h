@@ -0,0 +1,78 @@
+#ifndef SYNTHESIZER_H
+#define SYNTHESIZER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "schedule.h"
+
+/* Sintesi offline di uno schedule clock-driven a partire dai parametri dei task periodici
+   (tutti i tempi in quanti temporali, come frame_length e wcet dell'Executive).
+
+   Il sintetizzatore sceglie la lunghezza del frame tra i divisori dell'iperperiodo, assegna
+   ogni job a un frame compreso tra il suo rilascio e la sua deadline e, se necessario, lo
+   divide in più parti (i "tau_3,1", "tau_3,2", ... di application_1). Ogni parte distinta
+   (task, indice della parte, WCET) diventa un task dell'Executive. Tra le lunghezze di frame
+   ammissibili vince quella con meno preemption (parti in più), poi con lo slack minimo più
+   grande, poi la più lunga. Es.:
+
+	SynthesizedSchedule s = synthesize_schedule({{4, 1}, {5, 2}, {20, 5}});
+	Executive exec(s.slices.size(), s.frame_length, 10);
+	exec.set_schedule(s.table());
+	for (size_t id = 0; id < s.slices.size(); ++id)
+		exec.set_periodic_task(id, funzione_della_parte(s.slices[id]));
+*/
+
+struct PeriodicTaskSpec {
+	unsigned int period;
+	unsigned int wcet;
+	unsigned int deadline = 0;  // deadline relativa (0: uguale al periodo), al più il periodo
+};
+
+struct SynthesisOptions {
+	unsigned int frame_length = 0;  // lunghezza del frame imposta (0: scelta dal sintetizzatore)
+	bool allow_split = true;        // consente di dividere i job tra più frame
+	size_t max_frames = 1 << 20;    // scarta le lunghezze di frame con più frame per iperperiodo
+};
+
+struct SynthesizedSchedule {
+	// Parte di un task periodico, eseguita come un task dell'Executive (id = indice in slices)
+	struct Slice {
+		size_t task;        // indice del task periodico in ingresso
+		unsigned int part;  // indice della parte nel job (0 se il job non è diviso)
+		unsigned int wcet;
+	};
+
+	unsigned long long hyperperiod;
+	unsigned int frame_length;
+	unsigned int preemptions;   // parti in più rispetto ai job dell'iperperiodo
+	int min_slack;              // slack del frame più carico
+	std::vector<Slice> slices;
+	std::vector<std::vector<size_t>> frames;  // id delle slice di ciascun frame, nell'ordine di esecuzione
+
+	size_t num_frames() const { return frames.size(); }
+
+	/* Tabella piatta per Executive::set_schedule (punta ai vettori interni: valida finchè
+	   esiste l'oggetto e non viene modificato) */
+	ScheduleTable table() const;
+
+	std::vector<unsigned int> table_wcet;
+	std::vector<uint16_t> table_jobs;
+	std::vector<uint32_t> table_frame_begin;
+	std::vector<int> table_slack;
+	std::vector<long long> table_slack_prefix;
+};
+
+class synthesis_error : public std::runtime_error {
+public:
+	explicit synthesis_error(const std::string & what) : std::runtime_error(what) {}
+};
+
+/* Sintetizza lo schedule del task set; lancia synthesis_error se i parametri non sono validi
+   o se nessuna lunghezza di frame ammissibile produce uno schedule fattibile */
+SynthesizedSchedule synthesize_schedule(const std::vector<PeriodicTaskSpec> & tasks,
+                                        const SynthesisOptions & options = SynthesisOptions());
+
+#endif // SYNTHESIZER_H
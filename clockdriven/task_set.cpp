@@ -0,0 +1,72 @@
+#include "task_set.h"
+#include <cassert>
+#include <numeric>
+
+size_t TaskSet::add_task(Executive::Task function, const PeriodicTaskSpec & spec, Executive::OverrunPolicy policy) {
+    PeriodicTaskSpec s = spec;
+    if (s.deadline == 0)
+        s.deadline = s.period;
+    assert(s.period > 0 && s.wcet > 0 && s.wcet <= s.deadline && s.deadline <= s.period);
+    functions.push_back(std::move(function));
+    specs.push_back(s);
+    policies.push_back(policy);
+    return specs.size() - 1;
+}
+
+double TaskSet::utilization() const {
+    double u = 0.0;
+    for (const auto& s : specs)
+        u += static_cast<double>(s.wcet) / s.period;
+    return u;
+}
+
+TaskSet::Plan TaskSet::plan(Executive::SchedPolicy policy, const SynthesisOptions & options) const {
+    assert(!specs.empty());
+    Plan p;
+    p.policy = policy;
+
+    if (policy != Executive::SchedPolicy::Cyclic) {
+        // tick: il più lungo che cade su tutti i rilasci e su tutte le deadline
+        unsigned int tick = 0;
+        for (const auto& s : specs)
+            tick = std::gcd(tick, std::gcd(s.period, s.deadline));
+        p.frame_length = tick;
+        return p;
+    }
+
+    // una slice per task (job non divisi): gli id dell'executive restano quelli del task set
+    SynthesisOptions o = options;
+    o.allow_split = false;
+    SynthesizedSchedule s = synthesize_schedule(specs, o);
+    p.frame_length = s.frame_length;
+    p.frames.reserve(s.num_frames());
+    for (const auto& frame : s.frames) {
+        std::vector<size_t> ids;
+        ids.reserve(frame.size());
+        for (size_t slice : frame)
+            ids.push_back(s.slices[slice].task);
+        p.frames.push_back(std::move(ids));
+    }
+    return p;
+}
+
+void TaskSet::apply(Executive & exec, const Plan & plan) const {
+    exec.set_policy(plan.policy);
+    for (size_t id = 0; id < specs.size(); ++id) {
+        // l'executive chiama la funzione che resta nel task set (un puntatore: nessuna allocazione)
+        const Executive::Task* f = &functions[id];
+        exec.set_periodic_task(id, [f]() { (*f)(); }, specs[id].wcet, policies[id]);
+        if (plan.policy != Executive::SchedPolicy::Cyclic)
+            exec.set_task_timing(id, specs[id].period, specs[id].deadline);
+    }
+    for (const auto& frame : plan.frames)
+        exec.add_frame(frame);
+}
+
+std::unique_ptr<Executive> TaskSet::make_executive(Executive::SchedPolicy policy, std::chrono::nanoseconds unit_duration,
+                                                   const SynthesisOptions & options) const {
+    Plan p = plan(policy, options);
+    std::unique_ptr<Executive> exec(new Executive(specs.size(), p.frame_length, unit_duration));
+    apply(*exec, p);
+    return exec;
+}
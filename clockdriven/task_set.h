@@ -0,0 +1,81 @@
+#ifndef TASK_SET_H
+#define TASK_SET_H
+
+#include <vector>
+#include <memory>
+#include <chrono>
+
+#include "executive.h"
+#include "synthesizer.h"
+
+/* Task set periodico registrato una sola volta (funzione, periodo, WCET e deadline di ogni task,
+   in quanti temporali), da eseguire con ciascuna politica di Executive::SchedPolicy per confrontarle
+   sullo stesso carico: gli id dei task, le statistiche e la trace sono gli stessi in tutte.
+   Con Cyclic lo schedule viene sintetizzato (synthesize_schedule) senza dividere i job, perché le
+   funzioni dei task non sono divisibili; con RateMonotonic ed Edf il frame dell'Executive è il tick
+   dei rilasci, il MCD di periodi e deadline. Es.:
+
+	TaskSet set;
+	set.add_task(task0, {4, 1});
+	set.add_task(task1, {8, 2});
+	set.add_task(task2, {8, 2, 6});
+	std::unique_ptr<Executive> exec = set.make_executive(Executive::SchedPolicy::Edf, std::chrono::milliseconds(10));
+	exec->start();
+
+   Oppure, per configurare l'Executive prima dei task (es. set_execution_mode, Simulator):
+
+	TaskSet::Plan plan = set.plan(Executive::SchedPolicy::Cyclic);
+	Executive exec(set.size(), plan.frame_length, 10);
+	Simulator sim(exec);
+	set.apply(exec, plan);
+
+   Le funzioni restano nel TaskSet, che deve restare valido (e non essere modificato) finchè
+   gli executive costruiti sono in esecuzione.
+*/
+class TaskSet {
+public:
+	// Parametri dell'Executive per una politica
+	struct Plan {
+		Executive::SchedPolicy policy;
+		unsigned int frame_length;                  // frame (Cyclic) o tick dei rilasci (RM, EDF)
+		std::vector<std::vector<size_t>> frames;    // tabella dei frame, per add_frame (solo Cyclic)
+	};
+
+	/* [INIT] Registra un task periodico e ne restituisce l'id (progressivo, da 0):
+		function: funzione da eseguire a ogni rilascio;
+		spec: periodo, WCET e deadline relativa (0 = pari al periodo), con wcet <= deadline <= period;
+		policy: trattamento dei job che non rispettano la deadline.
+	*/
+	size_t add_task(Executive::Task function, const PeriodicTaskSpec & spec,
+	                Executive::OverrunPolicy policy = Executive::OverrunPolicy::Skip);
+
+	size_t size() const { return specs.size(); }
+	const PeriodicTaskSpec & spec(size_t id) const { return specs[id]; }
+
+	/* Utilizzazione del task set: somma dei WCET / periodo */
+	double utilization() const;
+
+	/* Parametri dell'Executive per la politica indicata; con Cyclic lancia synthesis_error se
+		nessun frame ammissibile produce uno schedule fattibile (options.allow_split viene ignorato):
+		policy: politica di scheduling;
+		options: opzioni della sintesi (solo Cyclic).
+	*/
+	Plan plan(Executive::SchedPolicy policy, const SynthesisOptions & options = SynthesisOptions()) const;
+
+	/* Registra i task nell'executive secondo "plan" (politica, task, tempi e frame); l'executive deve
+		avere size() task e frame_length pari a plan.frame_length */
+	void apply(Executive & exec, const Plan & plan) const;
+
+	/* Costruisce e configura un executive per la politica indicata (vedi plan e apply):
+		unit_duration: durata dell'unità di tempo.
+	*/
+	std::unique_ptr<Executive> make_executive(Executive::SchedPolicy policy, std::chrono::nanoseconds unit_duration,
+	                                          const SynthesisOptions & options = SynthesisOptions()) const;
+
+private:
+	std::vector<Executive::Task> functions;
+	std::vector<PeriodicTaskSpec> specs;
+	std::vector<Executive::OverrunPolicy> policies;
+};
+
+#endif // TASK_SET_H
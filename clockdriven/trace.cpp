@@ -0,0 +1,243 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#if defined(TRACE_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TRACE_USE_TSC
+#endif
+
+#include "rt/priority.h"
+
+namespace {
+
+// intestazione dei file di trace binari
+struct TraceHeader {
+    char magic[8];
+    double ticks_per_us;
+    uint64_t origin;
+};
+
+const char TRACE_MAGIC[8] = {'C', 'E', 'T', 'R', 'A', 'C', 'E', '1'};
+
+}
+
+Tracer::Ring::Ring(size_t capacity, uint16_t id_)
+    : id(id_), buffer(new TraceRecord[capacity]()), mask(capacity - 1)  // azzerato: pagine già mappate al primo evento
+{
+}
+
+bool Tracer::Ring::push(const TraceRecord& r) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > mask) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    buffer[h & mask] = r;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool Tracer::Ring::empty() const {
+    return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+}
+
+bool Tracer::Ring::pop(TraceRecord& r) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+        return false;
+    r = buffer[t & mask];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+Tracer& Tracer::global() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+    : origin_ticks(clock()), origin_time(std::chrono::steady_clock::now())
+{
+}
+
+Tracer::~Tracer() {
+    stop_drain_thread();
+}
+
+uint64_t Tracer::clock() {
+#ifdef TRACE_USE_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+double Tracer::ticks_per_us() const {
+#ifdef TRACE_USE_TSC
+    // calibrazione del TSC rispetto a steady_clock dall'avvio del tracer
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin_time).count();
+    return us > 0 ? (clock() - origin_ticks) / us : 1000.0;
+#else
+    return 1000.0;
+#endif
+}
+
+void Tracer::set_ring_capacity(size_t records) {
+    size_t n = 2;
+    while (n < records)
+        n <<= 1;
+    std::lock_guard<std::mutex> lg(rings_mtx);
+    ring_capacity = n;
+}
+
+void Tracer::set_enabled(bool e) {
+    enabled.store(e, std::memory_order_relaxed);
+}
+
+thread_local Tracer::LocalRing Tracer::local;
+
+Tracer::LocalRing::~LocalRing() {
+    // i record rimasti vengono ancora scritti dal prossimo drain, che poi libera il ring
+    if (ring)
+        ring->retired.store(true, std::memory_order_release);
+}
+
+void Tracer::reclaim_retired() {
+    // (con rings_mtx) libera i ring dei thread terminati già svuotati
+    for (size_t i = 0; i < rings.size();) {
+        Ring& ring = *rings[i];
+        if (!ring.retired.load(std::memory_order_acquire) || !ring.empty()) {
+            ++i;
+            continue;
+        }
+        retired_dropped += ring.dropped.load(std::memory_order_relaxed);
+        rings[i] = std::move(rings.back());
+        rings.pop_back();
+    }
+}
+
+void Tracer::attach_thread() {
+    if (local.ring != nullptr)
+        return;
+    std::lock_guard<std::mutex> lg(rings_mtx);
+    reclaim_retired();
+    rings.emplace_back(new Ring(ring_capacity, next_ring_id++));
+    local.ring = rings.back().get();
+}
+
+void Tracer::emit(TraceEvent event, uint16_t task, uint32_t frame, int32_t value) noexcept {
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    // thread non registrato: allocare il ring qui richiederebbe un lock nel percorso critico
+    Ring* ring = local.ring;
+    if (ring == nullptr) {
+        unattached_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TraceRecord r;
+    r.time = clock();
+    r.frame = frame;
+    r.value = value;
+    r.task = task;
+    r.thread = ring->id;
+    r.event = static_cast<uint8_t>(event);
+    std::memset(r.pad, 0, sizeof(r.pad));
+    ring->push(r);
+}
+
+uint64_t Tracer::dropped() const {
+    std::lock_guard<std::mutex> lg(rings_mtx);
+    uint64_t n = retired_dropped + unattached_dropped.load(std::memory_order_relaxed);
+    for (auto& r : rings)
+        n += r->dropped.load(std::memory_order_relaxed);
+    return n;
+}
+
+void Tracer::write_header(std::ostream& out) {
+    TraceHeader h;
+    std::memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+    h.ticks_per_us = ticks_per_us();
+    h.origin = origin_ticks;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+size_t Tracer::drain(std::ostream& out, Format fmt) {
+    std::lock_guard<std::mutex> lg(rings_mtx);
+
+    // raccoglie i record di tutti i ring e li ordina per tempo
+    drain_buffer.clear();
+    TraceRecord r;
+    for (auto& ring : rings)
+        while (ring->pop(r))
+            drain_buffer.push_back(r);
+    reclaim_retired();
+
+    std::stable_sort(drain_buffer.begin(), drain_buffer.end(),
+        [](const TraceRecord& a, const TraceRecord& b) { return a.time < b.time; });
+
+    if (fmt == Format::Binary) {
+        if (!drain_buffer.empty())
+            out.write(reinterpret_cast<const char*>(drain_buffer.data()), drain_buffer.size() * sizeof(TraceRecord));
+    } else {
+        // formatta tutto il blocco prima di scriverlo, per non mescolarlo con altre scritture sullo stream
+        std::ostringstream text;
+        double tpu = ticks_per_us();
+        for (auto& rec : drain_buffer)
+            format(text, rec, tpu, origin_ticks);
+        out << text.str();
+    }
+    out.flush();
+    return drain_buffer.size();
+}
+
+void Tracer::start_drain_thread(std::ostream& out, Format fmt, std::chrono::milliseconds period) {
+    stop_drain_thread();
+    if (fmt == Format::Binary)
+        write_header(out);
+
+    drain_stop.store(false);
+    drain_thread = std::thread([this, &out, fmt, period]() {
+        while (!drain_stop.load()) {
+            std::this_thread::sleep_for(period);
+            drain(out, fmt);
+        }
+        drain(out, fmt);
+    });
+    // il drain non deve mai competere con executive e task
+    rt::set_priority(drain_thread, rt::priority::not_rt);
+}
+
+void Tracer::stop_drain_thread() {
+    if (drain_thread.joinable()) {
+        drain_stop.store(true);
+        drain_thread.join();
+    }
+}
+
+const char* Tracer::event_name(uint8_t event) {
+    static const char* names[] = {
+        "FrameStart", "Release", "JobStart", "JobEnd", "DeadlineMiss",
+        "ApRequest", "PriorityChange", "SlackReclaim", "ApNotAdmitted",
+        "TimerOverrun", "ModeChange", "BudgetOverrun", "JobCancel", "RtViolation"
+    };
+    return event < sizeof(names) / sizeof(names[0]) ? names[event] : "?";
+}
+
+void Tracer::format(std::ostream& out, const TraceRecord& r, double tpu, uint64_t origin) {
+    double us = (static_cast<double>(r.time) - static_cast<double>(origin)) / tpu;
+    out << std::fixed << std::setprecision(3) << std::setw(14) << us / 1000.0 << " ms"
+        << "  thr " << std::setw(3) << r.thread
+        << "  frame " << std::setw(6) << r.frame
+        << "  " << std::left << std::setw(14) << event_name(r.event) << std::right;
+    if (r.task != TRACE_NO_TASK)
+        out << "  task " << r.task;
+    else
+        out << "  ap";
+    if (r.value != 0)
+        out << "  value " << r.value;
+    out << '\n';
+}
@@ -0,0 +1,144 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/* Tracer di eventi sempre attivo: ogni thread scrive record binari di dimensione fissa nel proprio
+   ring single-producer/single-consumer (nessun lock, allocazione o syscall nel percorso critico);
+   i ring vengono svuotati su richiesta o da un thread a bassa priorità su uno stream.
+   Il ring si alloca registrando il thread con attach_thread() (i thread dell'executive lo fanno
+   all'avvio): gli eventi dei thread non registrati vengono scartati e contati in dropped().
+   Il ring di un thread terminato viene liberato dopo che è stato svuotato.
+   Con TRACE_TSC definita i record usano il time-stamp counter x86 invece di steady_clock. */
+
+enum class TraceEvent : uint8_t {
+	FrameStart,      // task = indice del frame nell'iperperiodo
+	Release,         // task = job rilasciato, value = 1 se esegue la funzione di riserva (OverrunPolicy::Fallback)
+	JobStart,
+	JobEnd,
+	DeadlineMiss,
+	ApRequest,       // task = classe, value = 1 accettata in coda / 0 rifiutata
+	PriorityChange,  // value = nuova priorità
+	SlackReclaim,    // value = slack recuperato (us)
+	ApNotAdmitted,   // task = classe del job sporadico respinto
+	TimerOverrun,    // value = confini di frame persi (frame saltati)
+	ModeChange,      // value = nuovo modo (dal frame del record)
+	BudgetOverrun,   // task = job che ha superato il WCET (budget di CPU esaurito)
+	JobCancel,       // task = job in ritardo a cui è stato chiesto l'annullamento (OverrunPolicy::Abort, Fallback)
+	RtViolation      // value = allocazioni + page fault di un thread dopo l'armamento (task: TRACE_NO_TASK per executive e server)
+};
+
+struct TraceRecord {
+	uint64_t time;      // ns di steady_clock, o tick TSC
+	uint32_t frame;     // numero del frame dall'avvio
+	int32_t value;
+	uint16_t task;
+	uint16_t thread;    // ring (thread) che ha prodotto il record
+	uint8_t event;      // TraceEvent
+	uint8_t pad[3];
+};
+
+static_assert(sizeof(TraceRecord) == 24, "trace records must stay fixed-size");
+
+// id usato per i record che non riguardano un task periodico (es. il server aperiodico)
+const uint16_t TRACE_NO_TASK = 0xFFFF;
+
+class Tracer {
+public:
+	enum class Format { Binary, Text };
+
+	static Tracer & global();
+
+	/* [INIT] Capacità (in record) dei ring dei thread che verranno registrati da ora in poi */
+	void set_ring_capacity(size_t records);
+
+	/* [RUN] Abilita/disabilita la registrazione degli eventi (abilitata di default) */
+	void set_enabled(bool enabled);
+
+	/* [RUN] Registra il thread chiamante, allocando il suo ring (prende un lock: fuori dal percorso critico) */
+	void attach_thread();
+
+	/* [RUN] Registra un evento nel ring del thread chiamante (scartato se il thread non è registrato) */
+	void emit(TraceEvent event, uint16_t task, uint32_t frame, int32_t value = 0) noexcept;
+
+	/* [RUN] Svuota tutti i ring sullo stream, ordinando i record per tempo; restituisce i record scritti.
+		In formato Binary, la prima chiamata su uno stream va preceduta da write_header().
+	*/
+	size_t drain(std::ostream & out, Format format = Format::Binary);
+
+	/* [RUN] Scrive l'intestazione di un file di trace binario */
+	void write_header(std::ostream & out);
+
+	/* [RUN] Avvia/ferma un thread a priorità non real-time che svuota periodicamente i ring */
+	void start_drain_thread(std::ostream & out, Format format = Format::Binary,
+	                        std::chrono::milliseconds period = std::chrono::milliseconds(100));
+	void stop_drain_thread();
+
+	/* [RUN] Record persi perché un ring era pieno o il thread non era registrato */
+	uint64_t dropped() const;
+
+	/* Tick del clock di trace per microsecondo (1000 con steady_clock) */
+	double ticks_per_us() const;
+
+	/* Scrive un record in forma leggibile */
+	static void format(std::ostream & out, const TraceRecord & r, double ticks_per_us, uint64_t origin);
+
+	static const char * event_name(uint8_t event);
+
+	~Tracer();
+
+private:
+	class Ring {
+	public:
+		Ring(size_t capacity, uint16_t id);
+		bool push(const TraceRecord & r);
+		bool pop(TraceRecord & r);
+		bool empty() const;
+
+		const uint16_t id;
+		std::atomic<uint64_t> dropped{0};
+		std::atomic<bool> retired{false};   // thread terminato: liberato quando è vuoto
+
+	private:
+		std::unique_ptr<TraceRecord[]> buffer;
+		const size_t mask;
+		alignas(64) std::atomic<size_t> head{0};   // scritto dal produttore
+		alignas(64) std::atomic<size_t> tail{0};   // scritto dal consumatore
+	};
+
+	// ring del thread, segnato come ritirato alla terminazione del thread
+	struct LocalRing {
+		Ring * ring{nullptr};
+		~LocalRing();
+	};
+	static thread_local LocalRing local;
+
+	Tracer();
+	void reclaim_retired();
+	static uint64_t clock();
+
+	std::atomic<bool> enabled{true};
+	size_t ring_capacity{1024};
+
+	mutable std::mutex rings_mtx;               // solo registrazione dei thread e drain
+	std::vector<std::unique_ptr<Ring>> rings;
+	uint16_t next_ring_id{0};
+	std::atomic<uint64_t> unattached_dropped{0};
+	uint64_t retired_dropped{0};                // record persi dai ring già liberati
+	std::vector<TraceRecord> drain_buffer;
+
+	uint64_t origin_ticks;
+	std::chrono::steady_clock::time_point origin_time;
+
+	std::thread drain_thread;
+	std::atomic<bool> drain_stop{false};
+};
+
+#endif // TRACE_H
@@ -0,0 +1,43 @@
+// Decodes a binary trace written by Tracer (Format::Binary) into readable text.
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "trace.h"
+
+int main(int argc, char * argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage: " << argv[0] << " <trace file>" << std::endl;
+		return 1;
+	}
+
+	std::ifstream in(argv[1], std::ios::binary);
+	if (!in)
+	{
+		std::cerr << "cannot open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	char magic[8];
+	double ticks_per_us;
+	uint64_t origin;
+
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char *>(&ticks_per_us), sizeof(ticks_per_us));
+	in.read(reinterpret_cast<char *>(&origin), sizeof(origin));
+
+	if (!in || std::memcmp(magic, "CETRACE1", sizeof(magic)) != 0)
+	{
+		std::cerr << argv[1] << ": not a trace file" << std::endl;
+		return 1;
+	}
+
+	TraceRecord r;
+	while (in.read(reinterpret_cast<char *>(&r), sizeof(r)))
+		Tracer::format(std::cout, r, ticks_per_us, origin);
+
+	return 0;
+}